@@ -52,6 +52,7 @@
 #include <vector>
 #include <queue>  //  priority_queue
 
+#include <cstdint>  //  uint64_t
 #include <cstdlib>  //  NULL and srand
 
 using namespace std;
@@ -60,7 +61,10 @@ using namespace std;
 #include "check.hpp"
 #include "heapnode.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
 #include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
 #include "cluster.hpp"
 #include "score.hpp"
 #include "build_mst.hpp"
@@ -69,15 +73,68 @@ using namespace std;
 BUILDMST::BUILDMST ()
   : debug_flag (false),
     verbose_flag (false),
+    threads (1),
+    blocked (false),
+    precision (PREC_DOUBLE),
     distance (DIST_EUC),
     linkage (LINK_SINGLE),
     scoring (SCORE_GAPS),
     centroid (DIST_EUC),
     attr_fn (""),
     microarray_fn (""),
+    distance_matrix_fn (""),
+    matrix_fn (""),
+    cache_dir (""),
+    extend_fn (""),
+    sketch_dim (0),
+    sketch_seed (SKETCH_DEFAULT_SEED),
+    sketch_check (false),
+    pca_dim (0),
+    top_variance (0),
+    impute (IMPUTE_NONE),
+    stream_columns (0),
+    quantize (0),
+    reorder (false),
     path (""),
     M (0),
-    N (0)
+    N (0),
+    first_new (0),
+    column_begin (0),
+    column_end (0),
+    rank (0),
+    world_size (1),
+    data (),
+    exact (),
+    sketch_checked (0),
+    sketch_sum (0.0),
+    sketch_max (0.0),
+    ranked (),
+    ranks (),
+    kendall_order (),
+    kendall_ranks (),
+    kendall_count (),
+    mi_codes (),
+    sparse_rows (),
+    sparse_starts (),
+    sparse_columns (),
+    sparse_values (),
+    sparse_sums (),
+    sparse_squares (),
+    quant_rows (),
+    quant_stride (0),
+    quant8 (),
+    quant16 (),
+    quant_scales (),
+    quant_squares (),
+    quant_errors (),
+    quant_norms (),
+    quant_exact (),
+    quant_refined (0),
+    blocked_dense (),
+    blocked_norms (),
+    blocked_rows (),
+    dist_double (),
+    dist_float ()
 {
   //  Set the random seed using the current time
   srand (time (NULL));
@@ -104,6 +161,60 @@ bool BUILDMST::getVerbose () const {
   return verbose_flag;
 }
 
+//!  Set the number of threads used to calculate the distance matrix
+void BUILDMST::setThreads (unsigned int arg) {
+  threads = arg;
+}
+
+//!  Get the number of threads
+unsigned int BUILDMST::getThreads () const {
+  return threads;
+}
+
+//!  Set whether or not the blocked engine is used for rows without NULLs
+void BUILDMST::setBlocked (bool arg) {
+  blocked = arg;
+}
+
+//!  Get the blocked engine setting
+bool BUILDMST::getBlocked () const {
+  return blocked;
+}
+
+//!  Set the precision of the distance matrix
+void BUILDMST::setPrecision (PRECISION arg) {
+  precision = arg;
+}
+
+//!  Get the precision of the distance matrix
+PRECISION BUILDMST::getPrecision () const {
+  return precision;
+}
+
+//!  Get the distance matrix of doubles
+template <>
+DISTMATRIX<double> &BUILDMST::getDistMatrix<double> () {
+  return dist_double;
+}
+
+//!  Get the distance matrix of floats
+template <>
+DISTMATRIX<float> &BUILDMST::getDistMatrix<float> () {
+  return dist_float;
+}
+
+//!  Get the priority queue with double scores
+template <>
+HEAPQUEUE<double> &BUILDMST::getQueue<double> () {
+  return queue_double;
+}
+
+//!  Get the priority queue with float scores
+template <>
+HEAPQUEUE<float> &BUILDMST::getQueue<float> () {
+  return queue_float;
+}
+
 //!  Set the distance method
 void BUILDMST::setDistance (DIST_METHOD arg) {
   distance = arg;
@@ -174,6 +285,156 @@ string BUILDMST::getAttrFn () const {
   return attr_fn;
 }
 
+//!  Set the filename of a precomputed distance matrix
+void BUILDMST::setDistanceMatrixFn (string arg) {
+  string tmp = sanitizeFilename (arg);
+
+  distance_matrix_fn = "";
+  if (tmp.length () != 0) {
+    distance_matrix_fn = tmp;
+  }
+}
+
+//!  Get the filename of a precomputed distance matrix
+string BUILDMST::getDistanceMatrixFn () const {
+  return distance_matrix_fn;
+}
+
+//!  Set the filename of the memory-mapped distance matrix
+void BUILDMST::setMatrixFn (string arg) {
+  string tmp = sanitizeFilename (arg);
+
+  matrix_fn = "";
+  if (tmp.length () != 0) {
+    matrix_fn = tmp;
+  }
+}
+
+//!  Get the filename of the memory-mapped distance matrix
+string BUILDMST::getMatrixFn () const {
+  return matrix_fn;
+}
+
+//!  Set the directory of cached distance matrices
+void BUILDMST::setCacheDir (string arg) {
+  string tmp = sanitizePath (arg);
+
+  cache_dir = "";
+  if (tmp.length () != 0) {
+    cache_dir = tmp;
+  }
+}
+
+//!  Get the directory of cached distance matrices
+string BUILDMST::getCacheDir () const {
+  return cache_dir;
+}
+
+//!  Set the cache entry to be extended
+void BUILDMST::setExtendFn (string arg) {
+  string tmp = sanitizeFilename (arg);
+
+  extend_fn = "";
+  if (tmp.length () != 0) {
+    extend_fn = tmp;
+  }
+}
+
+//!  Get the cache entry to be extended
+string BUILDMST::getExtendFn () const {
+  return extend_fn;
+}
+
+//!  Set the number of dimensions the rows are projected into (0 = no projection)
+void BUILDMST::setSketchDim (unsigned int arg) {
+  sketch_dim = arg;
+}
+
+//!  Get the number of dimensions the rows are projected into
+unsigned int BUILDMST::getSketchDim () const {
+  return sketch_dim;
+}
+
+//!  Set the seed for the random projection
+void BUILDMST::setSketchSeed (unsigned int arg) {
+  sketch_seed = arg;
+}
+
+//!  Get the seed for the random projection
+unsigned int BUILDMST::getSketchSeed () const {
+  return sketch_seed;
+}
+
+//!  Set whether or not accepted merges are compared against the exact distances
+void BUILDMST::setSketchCheck (bool arg) {
+  sketch_check = arg;
+}
+
+//!  Get whether or not accepted merges are compared against the exact distances
+bool BUILDMST::getSketchCheck () const {
+  return sketch_check;
+}
+
+//!  Set the number of principal components the experiments are reduced to (0 = no reduction)
+void BUILDMST::setPcaDim (unsigned int arg) {
+  pca_dim = arg;
+}
+
+//!  Get the number of principal components the experiments are reduced to
+unsigned int BUILDMST::getPcaDim () const {
+  return pca_dim;
+}
+
+//!  Set the number of columns with the largest variance that are kept (0 = all)
+void BUILDMST::setTopVariance (unsigned int arg) {
+  top_variance = arg;
+}
+
+//!  Get the number of columns with the largest variance that are kept
+unsigned int BUILDMST::getTopVariance () const {
+  return top_variance;
+}
+
+//!  Set how NULLs are filled in before calculating distances
+void BUILDMST::setImpute (IMPUTE_METHOD arg) {
+  impute = arg;
+}
+
+//!  Get how NULLs are filled in before calculating distances
+IMPUTE_METHOD BUILDMST::getImpute () const {
+  return impute;
+}
+
+//!  Set the number of columns read at a time when the microarray file is streamed (0 = read in whole)
+void BUILDMST::setStreamColumns (unsigned int arg) {
+  stream_columns = arg;
+}
+
+//!  Get the number of columns read at a time when the microarray file is streamed
+unsigned int BUILDMST::getStreamColumns () const {
+  return stream_columns;
+}
+
+//!  Set the number of bits each expression level is quantized to for screening distances (0 = not quantized)
+void BUILDMST::setQuantize (unsigned int arg) {
+  quantize = arg;
+}
+
+//!  Get the number of bits each expression level is quantized to for screening distances
+unsigned int BUILDMST::getQuantize () const {
+  return quantize;
+}
+
+//!  Set whether or not the experiments are renumbered so that similar ones are close together
+void BUILDMST::setReorder (bool arg) {
+  reorder = arg;
+}
+
+//!  Get whether or not the experiments are renumbered so that similar ones are close together
+bool BUILDMST::getReorder () const {
+  return reorder;
+}
+
 //!  Set the output path (the path where files will be written to)
 void BUILDMST::setPath (string arg) {
   string tmp = sanitizePath (arg);
@@ -188,6 +449,26 @@ string BUILDMST::getPath () const {
   return path;
 }
 
+//!  Set the rank of this process
+void BUILDMST::setRank (unsigned int arg) {
+  rank = arg;
+}
+
+//!  Get the rank of this process
+unsigned int BUILDMST::getRank () const {
+  return rank;
+}
+
+//!  Set the total number of processes
+void BUILDMST::setWorldSize (unsigned int arg) {
+  world_size = arg;
+}
+
+//!  Get the total number of processes
+unsigned int BUILDMST::getWorldSize () const {
+  return world_size;
+}
+
 //!  Set M -- the number of objects (experiments or rows) in the data set
 void BUILDMST::setM (unsigned int arg) {
   M = arg;
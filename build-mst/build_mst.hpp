@@ -66,17 +66,103 @@ class BUILDMST {
     
     //  Main part of the class  [run.cpp]
     void run ();
+    template <typename T>
+    void agglomerate ();
 
     //  Data file I/O  [io.cpp]
     bool readMicroarray ();
+    bool readDistanceMatrix ();
+    bool readDistancesText (istream &fp);
+    bool readDistancesBinary (istream &fp);
     bool readAttr ();
 
     //  Calculate distances or clusters  [calculate.cpp]
     void initializeDistances ();
+    void calculateDistances ();
+    unsigned int calculateTileSize () const;
+    void calculateTile (unsigned int row, unsigned int col, unsigned int size);
+    template <NULL_PROFILE P>
+    void calculateTilePairs (unsigned int row, unsigned int col, unsigned int size);
+    template <NULL_PROFILE P = NULLS_GENERAL>
+    double calculateDistance (unsigned int i, unsigned int j);
+    void storeDistance (unsigned int i, unsigned int j, double score);
+    template <typename T>
+    unsigned int queueDistances ();
     void initializeClusters ();
+    template <typename T>
+    T calculateLink (unsigned int i, unsigned int j);
+    template <typename T>
     void calculateLinkage (CLUSTER &arg);
+    template <typename T>
     void calculateScores (SCORE &arg);
 
+    //  Sharing Spearman ranks between pairs  [calculate_spear.cpp]
+    void prepareRanks ();
+    void prepareSpearmanGroups ();
+    size_t spearmanPatternPairs (unsigned int p, unsigned int q) const;
+    bool spearmanGrouped (unsigned int i, unsigned int j) const;
+    void calculateSpearmanGroups ();
+
+    //  Sharing Kendall presorting between pairs  [calculate_kendall.cpp]
+    void prepareKendall ();
+
+    //  Discretising rows for the mutual information  [calculate_mi.cpp]
+    void prepareMutualInfo ();
+
+    //  Out-of-core distances for --stream-columns  [calculate_stream.cpp]
+    bool streamMicroarray ();
+    unsigned int streamSums () const;
+    template <NULL_PROFILE P>
+    void accumulateChunk (const EXPRMATRIX &chunk, vector<double> &sums, vector<double> &squares);
+    double finishStream (const double *sums, double norm1, double norm2) const;
+
+    //  Filling in NULLs for --impute  [calculate_impute.cpp]
+    void imputeData ();
+
+    //  Random projection of the rows for --sketch-dim  [calculate_sketch.cpp]
+    void sketchData ();
+    void checkSketch (unsigned int left, unsigned int right, double score);
+    void reportSketch () const;
+
+    //  Principal component analysis for --pca  [calculate_pca.cpp]
+    void reduceData ();
+
+    //  Compressed sparse rows for zero-heavy data  [calculate_sparse.cpp]
+    bool prepareSparse ();
+    double calculateSparse (unsigned int i, unsigned int j) const;
+
+    //  Screening with quantized rows for --quantize  [calculate_quant.cpp]
+    bool prepareQuantized ();
+    double calculateQuantized (unsigned int i, unsigned int j) const;
+    template <typename T>
+    bool refineDistance (unsigned int i, unsigned int j);
+    template <typename T>
+    bool refineLinkage (unsigned int left, unsigned int right, T &score);
+    void reportQuantized () const;
+
+    //  Renumbering the experiments for --reorder  [calculate_reorder.cpp]
+    void reorderData ();
+    unsigned int getOriginalID (unsigned int id) const;
+
+    //  Blocked engine for rows without NULLs  [calculate_blocked.cpp]
+    bool prepareBlocked ();
+    void calculateTileBlocked (unsigned int row, unsigned int col, unsigned int size);
+
+    //  Distance matrix in memory, in a file, or in the cache  [calculate_cache.cpp]
+    bool openDistances ();
+    template <typename T>
+    bool allocateDistances ();
+    template <typename T>
+    void extendDistances (const vector<uint64_t> &tag, const vector<uint64_t> &rows);
+    string cacheFilename (uint64_t hash) const;
+
+    //  Splitting the distance matrix between MPI processes  [transmit.cpp]
+    bool shareCached (bool arg);
+    void splitColumns (vector<unsigned int> &bounds) const;
+    void distributeColumns ();
+    template <typename T>
+    void gatherDistances ();
+
     //  Normalize and print the scores  [calculate.cpp]
     void normalizeScores ();
     bool printScores (string outpath);
@@ -86,6 +172,16 @@ class BUILDMST {
     bool getDebug () const;
     void setVerbose (bool arg);
     bool getVerbose () const;
+    void setThreads (unsigned int arg);
+    unsigned int getThreads () const;
+    void setBlocked (bool arg);
+    bool getBlocked () const;
+    void setPrecision (PRECISION arg);
+    PRECISION getPrecision () const;
+    template <typename T>
+    DISTMATRIX<T> &getDistMatrix ();
+    template <typename T>
+    HEAPQUEUE<T> &getQueue ();
 
     void setDistance (DIST_METHOD arg);
     DIST_METHOD getDistance () const;
@@ -100,8 +196,38 @@ class BUILDMST {
     string getMicroarrayFn () const;
     void setAttrFn (string arg);
     string getAttrFn () const;
+    void setDistanceMatrixFn (string arg);
+    string getDistanceMatrixFn () const;
+    void setMatrixFn (string arg);
+    string getMatrixFn () const;
+    void setCacheDir (string arg);
+    string getCacheDir () const;
+    void setExtendFn (string arg);
+    string getExtendFn () const;
+    void setSketchDim (unsigned int arg);
+    unsigned int getSketchDim () const;
+    void setSketchSeed (unsigned int arg);
+    unsigned int getSketchSeed () const;
+    void setSketchCheck (bool arg);
+    bool getSketchCheck () const;
+    void setPcaDim (unsigned int arg);
+    unsigned int getPcaDim () const;
+    void setTopVariance (unsigned int arg);
+    unsigned int getTopVariance () const;
+    void setImpute (IMPUTE_METHOD arg);
+    IMPUTE_METHOD getImpute () const;
+    void setStreamColumns (unsigned int arg);
+    unsigned int getStreamColumns () const;
+    void setQuantize (unsigned int arg);
+    unsigned int getQuantize () const;
+    void setReorder (bool arg);
+    bool getReorder () const;
     void setPath (string arg);
     string getPath () const;
+    void setRank (unsigned int arg);
+    unsigned int getRank () const;
+    void setWorldSize (unsigned int arg);
+    unsigned int getWorldSize () const;
     void setM (unsigned int arg);
     unsigned int getM () const;
     void setN (unsigned int arg);
@@ -111,6 +237,12 @@ class BUILDMST {
     bool debug_flag;
     //!  Set to true if verbose output is required; false otherwise
     bool verbose_flag;
+    //!  Number of threads used to calculate the distance matrix
+    unsigned int threads;
+    //!  Set to true if the blocked engine should be used for rows without NULLs
+    bool blocked;
+    //!  Precision of the distance matrix, the priority queue, and the linkage
+    enum PRECISION precision;
     //!  Distance method
     enum DIST_METHOD distance;
     //!  Linkage method
@@ -123,6 +255,32 @@ class BUILDMST {
     string attr_fn;
     //!  Microarray filename
     string microarray_fn;
+    //!  Filename of a precomputed distance matrix, read instead of the microarray file (empty if none)
+    string distance_matrix_fn;
+    //!  Filename of the memory-mapped distance matrix (empty if the matrix is kept in memory)
+    string matrix_fn;
+    //!  Directory of cached distance matrices (empty if there is no cache)
+    string cache_dir;
+    //!  Cache entry for an earlier version of the microarray file, to be extended (empty if none)
+    string extend_fn;
+    //!  Number of dimensions the rows are projected into (0 if they are not)
+    unsigned int sketch_dim;
+    //!  Seed for the random projection
+    unsigned int sketch_seed;
+    //!  Set to true if the distance of each accepted merge is compared against the exact one
+    bool sketch_check;
+    //!  Number of principal components the experiments are reduced to (0 if they are not)
+    unsigned int pca_dim;
+    //!  Number of columns with the largest variance that are kept (0 if all of them are)
+    unsigned int top_variance;
+    //!  How NULLs are filled in before calculating distances
+    enum IMPUTE_METHOD impute;
+    //!  Number of columns read at a time when the microarray file is streamed (0 if it is read in whole)
+    unsigned int stream_columns;
+    //!  Number of bits each expression level is quantized to for screening distances (0 if they are not)
+    unsigned int quantize;
+    //!  Whether or not the experiments are renumbered so that similar ones are close together
+    bool reorder;
     //!  Output path
     string path;
 
@@ -130,21 +288,115 @@ class BUILDMST {
     unsigned int M;
     //!  Number of columns
     unsigned int N;
+    //!  First experiment whose distances are calculated; the pairs among earlier ones were copied from the cache
+    unsigned int first_new;
+    //!  First column of the distance matrix calculated by this process
+    unsigned int column_begin;
+    //!  One past the last column of the distance matrix calculated by this process
+    unsigned int column_end;
+
+    //!  Rank of this process
+    unsigned int rank;
+    //!  Total number of processes
+    unsigned int world_size;
 
     //!  The vector of clusters; grows from M to at most (M + M - 1) entries
     vector<CLUSTER> clusters;
 
-    //!  The priority queue, implemented as a heap
-    priority_queue<HEAPNODE, std::vector<HEAPNODE>, greater<HEAPNODE> > pqueue;
+    //!  The priority queue, implemented as a heap (--precision double)
+    HEAPQUEUE<double> queue_double;
+    //!  The priority queue, implemented as a heap (--precision float)
+    HEAPQUEUE<float> queue_float;
 
     /*!  The vector of scores; each position in this array represents
     the score of the MST from one merge step.  */
     vector<SCORE> scores;
 
-    //!  Original microarray data with each row as an entry in this vector
-    vector<VECT> data;
-    //!  Distance matrix of size (M * M)
-    double **dist_matrix;
+    //!  Original microarray data with each experiment as a row of the matrix (projected with --sketch-dim)
+    EXPRMATRIX data;
+    //!  Original microarray data before the projection (--sketch-check only)
+    EXPRMATRIX exact;
+    //!  Number in the data file of each experiment, after renumbering by --reorder (empty if not)
+    vector<unsigned int> original_ids;
+    //!  Number of merges compared against the exact distances
+    unsigned int sketch_checked;
+    //!  Sum of the relative distortions of the merges compared
+    double sketch_sum;
+    //!  Largest relative distortion of the merges compared
+    double sketch_max;
+    //!  Rows without NULLs, whose Spearman ranks are calculated once in advance
+    vector<bool> ranked;
+    //!  Spearman ranks of the rows without NULLs
+    EXPRMATRIX ranks;
+    //!  NULL pattern of each row (Spearman correlation only)
+    vector<unsigned int> spear_patterns;
+    //!  Rows with each NULL pattern (Spearman correlation only)
+    vector<vector<unsigned int> > spear_pattern_rows;
+    //!  Combined NULL masks shared by more than one pair of rows (Spearman correlation only)
+    vector<vector<uint64_t> > spear_masks;
+    //!  Pairs of NULL patterns that use each mask in spear_masks
+    vector<vector<pair<unsigned int, unsigned int> > > spear_groups;
+    //!  Pairs of NULL patterns p <= q in spear_groups, as p * (number of patterns) + q, sorted
+    vector<uint64_t> spear_grouped;
+    //!  Non-null columns of each row sorted by expression level, N per row (Kendall correlation only)
+    vector<unsigned int> kendall_order;
+    //!  Dense rank of each column of each row, N per row (Kendall correlation only)
+    vector<unsigned int> kendall_ranks;
+    //!  Number of non-null columns of each row (Kendall correlation only)
+    vector<unsigned int> kendall_count;
+    //!  Bin code of each column of each row, N per row (mutual information only)
+    vector<uint8_t> mi_codes;
+    //!  Rows stored in compressed sparse form (see prepareSparse ())
+    vector<bool> sparse_rows;
+    //!  Offset of the first non-zero of each sparse row, M + 1 in all
+    vector<size_t> sparse_starts;
+    //!  Column of each non-zero of the sparse rows
+    vector<unsigned int> sparse_columns;
+    //!  Expression level of each non-zero of the sparse rows
+    vector<double> sparse_values;
+    //!  Sum of the expression levels of each sparse row (Pearson correlation only)
+    vector<double> sparse_sums;
+    //!  Sum of the squared expression levels of each sparse row (Pearson correlation only)
+    vector<double> sparse_squares;
+    //!  Rows quantized for --quantize (see prepareQuantized ())
+    vector<bool> quant_rows;
+    //!  Number of quantized expression levels per row, including the padding
+    unsigned int quant_stride;
+    //!  Rows quantized to 8 bits, quant_stride per row
+    vector<int8_t> quant8;
+    //!  Rows quantized to 16 bits, quant_stride per row
+    vector<int16_t> quant16;
+    //!  Scale of each quantized row
+    vector<double> quant_scales;
+    //!  Sum of the squared quantized expression levels of each row
+    vector<double> quant_squares;
+    //!  Norm of the rounding error of each quantized row
+    vector<double> quant_errors;
+    //!  Exact norm of each quantized row (after centering, for the Pearson correlation)
+    vector<double> quant_norms;
+    //!  Pairs of quantized rows whose distance has been recalculated exactly
+    vector<bool> quant_exact;
+    //!  Number of distances recalculated exactly by refineLinkage ()
+    size_t quant_refined;
+    //!  Rows without NULLs, which are handled by the blocked engine
+    vector<bool> blocked_dense;
+    //!  Norm of each row for the blocked engine (squared for the Euclidean distance)
+    vector<double> blocked_norms;
+    //!  Standardised rows (or ranks) for the blocked engine (not for the Euclidean distance)
+    EXPRMATRIX blocked_rows;
+    //!  Distances between every pair of experiments (--precision double)
+    DISTMATRIX<double> dist_double;
+    //!  Distances between every pair of experiments (--precision float)
+    DISTMATRIX<float> dist_float;
 };
 
+template <>
+DISTMATRIX<double> &BUILDMST::getDistMatrix<double> ();
+template <>
+DISTMATRIX<float> &BUILDMST::getDistMatrix<float> ();
+template <>
+HEAPQUEUE<double> &BUILDMST::getQueue<double> ();
+template <>
+HEAPQUEUE<float> &BUILDMST::getQueue<float> ();
+
 #endif
@@ -55,14 +55,25 @@
 #include <queue>  //  priority_queue
 #include <fstream>  //  ofstream
 
+#include <algorithm>  //  min, max
+#include <utility>  //  pair
+
+#include <cstdint>  //  uint64_t
 #include <cstdlib>  //  exit, EXIT_FAILURE
 
 using namespace std;
 
+#include "BuildMSTConfig.hpp"
 #include "global_defn.hpp"
+#include "vect_simd.hpp"
 #include "heapnode.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect_kendall.hpp"
+#include "vect_mi.hpp"
 #include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
 #include "cluster.hpp"
 #include "score.hpp"
 #include "build_mst.hpp"
@@ -74,75 +85,343 @@ using namespace std;
      functions.  That is, a low value (0) indicates highly similar and a
      high value indicates highly dissimilar.
 
-     Distances are stored twice in the matrix -- on both sides of the
-     diagonal.  As distances are calculated, they are added into the
-     priority queue.
+     The distances are calculated unless a matching distance matrix is
+     found in the cache (see allocateDistances ()), a precomputed matrix
+     was read in by readDistanceMatrix (), or the distances were found
+     while streaming the microarray file by streamMicroarray ().  Once the matrix is complete,
+     the distances are added into the priority queue in row order.
+
+     If MPI is in use, only the primary process looks in the cache, and
+     the other processes only calculate their share of the distances.
+
+     With --quantize, the matrix holds lower bounds for the quantized
+     pairs, whether it was calculated or found in the cache.  The rows are
+     quantized again after a cache hit so that refineLinkage () knows
+     which pairs to recalculate, and a memory-mapped matrix is detached
+     from its file so that the exact distances are only kept for this run.
 */
 void BUILDMST::initializeDistances () {
-  double score = 0.0;
   unsigned int total = 0;
-  HEAPNODE heapnode;
+  bool cached = false;
+
+  if (getDistanceMatrixFn ().empty () && (getStreamColumns () == 0)) {
+    cached = (getRank () == 0) ? openDistances () : false;
+    if (!shareCached (cached)) {
+      distributeColumns ();
+      calculateDistances ();
+    }
+  }
+
+  if (getRank () != 0) {
+    return;
+  }
+
+  if (getQuantize () != 0) {
+    if (cached) {
+      prepareSparse ();
+      prepareQuantized ();
+    }
+    if (getPrecision () == PREC_FLOAT) {
+      dist_float.detach ();
+    }
+    else {
+      dist_double.detach ();
+    }
+  }
+
+  if (getPrecision () == PREC_FLOAT) {
+    total = queueDistances<float> ();
+  }
+  else {
+    total = queueDistances<double> ();
+  }
 
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tNumber of pairs calculated:" << total << endl;
+  }
+
+  return;
+}
+
+
+//!  Calculate the distance between every pair of experiments
+/*!
+     Only the distances above the diagonal are stored (see DISTMATRIX).
+     The upper triangle is split into square tiles which are
+     handed out to the threads one at a time; since every distance is
+     written to its own cell, the matrix does not depend on the number
+     of threads.  Pairs where both experiments come before first_new
+     were copied from the cache and are skipped.  Only the columns from
+     column_begin to column_end are calculated by this process; the rest
+     are gathered from the other MPI processes.
+*/
+void BUILDMST::calculateDistances () {
   unsigned int i;
   unsigned int j;
-  unsigned int end;
-
-  //  Create the distance matrix
-  unsigned int m = getM ();
-  dist_matrix = new double*[m];
-  for (i = 0; i < m; i++) {
-    dist_matrix[i] = new double[m];
-    for (j = 0; j < m; j++) {
-      dist_matrix[i][j] = 0.0;
+
+  //  List the tiles of the upper triangle in this process' columns,
+  //    including those on the diagonal
+  unsigned int size = calculateTileSize ();
+  vector<pair<unsigned int, unsigned int> > tiles;
+  for (i = 0; i < column_end; i += size) {
+    for (j = column_begin; j < column_end; j += size) {
+      if ((j + size > i + 1) && (j + size > first_new)) {
+        tiles.push_back (make_pair (i, j));
+      }
     }
   }
 
-  end = data.size ();
+  if (getDistance () == DIST_SPEAR) {
+    prepareRanks ();
+    prepareSpearmanGroups ();
+  }
+  else if (getDistance () == DIST_KENDALL) {
+    prepareKendall ();
+  }
+  else if (getDistance () == DIST_MI) {
+    prepareMutualInfo ();
+  }
+  prepareSparse ();
+  prepareQuantized ();
+  bool use_blocked = prepareBlocked ();
+  int num_tiles = static_cast<int> (tiles.size ());
+  int t = 0;
+
+  //  Tiles on the diagonal have half as many pairs as the others, so
+  //  they are handed out dynamically rather than in fixed blocks
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads (getThreads ())
+#endif
+  for (t = 0; t < num_tiles; t++) {
+    if (use_blocked) {
+      calculateTileBlocked (tiles[t].first, tiles[t].second, size);
+    }
+    else {
+      calculateTile (tiles[t].first, tiles[t].second, size);
+    }
+  }
+  if (getDistance () == DIST_SPEAR) {
+    calculateSpearmanGroups ();
+  }
+
+  //  Collect the columns of the other processes, then complete the
+  //    file, if the matrix is memory-mapped
+  if (getPrecision () == PREC_FLOAT) {
+    gatherDistances<float> ();
+    dist_float.finish ();
+  }
+  else {
+    gatherDistances<double> ();
+    dist_double.finish ();
+  }
+
+  return;
+}
+
+
+//!  Store the distance between experiments i and j in the distance matrix with the chosen precision
+void BUILDMST::storeDistance (unsigned int i, unsigned int j, double score) {
+  if (getPrecision () == PREC_FLOAT) {
+    dist_float.set (i, j, score);
+  }
+  else {
+    dist_double.set (i, j, score);
+  }
+}
+
+
+//!  Add the distances above the diagonal into the priority queue
+/*!
+     \return The number of distances added
+
+     T is the precision of the distance matrix.
+*/
+template <typename T>
+unsigned int BUILDMST::queueDistances () {
+  T score = 0;
+  unsigned int total = 0;
+  HEAPNODE<T> heapnode;
+  const DISTMATRIX<T> &dist_matrix = getDistMatrix<T> ();
+  HEAPQUEUE<T> &pqueue = getQueue<T> ();
+
+  unsigned int i;
+  unsigned int j;
+  unsigned int end = data.getM ();
   for (i = 0; i < end; i++) {
     //  No self-loops allowed in graph
     for (j = i + 1; j < end; j++) {
-      //  All functions return a dissimilarity score
-      switch (getDistance ()) {
-        case DIST_EUC :
-          score = data[i].simEuc (&data[j]);
-          break;
-        case DIST_MAN :
-          score = data[i].simMan (&data[j]);
-          break;
-        case DIST_PEAR :
-          score = data[i].simPear (&data[j]);
-          break;
-        case DIST_SPEAR :
-          score = data[i].simSpear (&data[j]);
-          break;
-      }
+      score = dist_matrix.get (i, j);
       if (getDebug ()) {
         //  Print the distance we calculated
-        cout << setprecision (6) << score << "\t" << i << "\t" << j << endl;
+        cout << setprecision (6) << score << "\t" << getOriginalID (i) << "\t" << getOriginalID (j) << endl;
       }
 
       //  Add the distance to the heap; the priority queue is actually
       //  a queue of clusters and not experiment nodes.  But at this
       //  stage, they both mean the same thing; so it is fine to do this
       //  as long as the vector of ID i is also in cluster ID i.
-      heapnode = HEAPNODE (data[i].getID (), data[j].getID (), score);
+      heapnode = HEAPNODE<T> (i, j, score);
       pqueue.push (heapnode);
 
-      //  Set the score on both sides of the diagonal
-      dist_matrix[i][j] = score;
-      dist_matrix[j][i] = score;
-
       total++;
     }
   }
 
-  if (getVerbose ()) {
-    cerr << left << setw (VERBOSE_WIDTH) << "==\tNumber of pairs calculated:" << total << endl;
+  return total;
+}
+
+
+//!  Calculate the number of rows along each side of a tile of the distance matrix
+/*!
+     A tile covers two blocks of rows and both should stay in the cache
+     while the tile is being calculated.  Tiles are kept small enough so
+     that there are plenty of them to go around when many threads are used.
+*/
+unsigned int BUILDMST::calculateTileSize () const {
+  unsigned int size = DIST_TILE_BYTES / (2 * sizeof (double) * (getN () + 1));
+
+  if (size == 0) {
+    size = 1;
+  }
+  else if (size > DIST_TILE_MAX_ROWS) {
+    size = DIST_TILE_MAX_ROWS;
+  }
+
+  return size;
+}
+
+
+//!  Calculate the distances within one tile of the distance matrix
+/*!
+     \param row The first row of the tile
+     \param col The first column of the tile
+     \param size The number of rows (and columns) along each side of a tile
+
+     The distance kernels are chosen once for the whole tile, based on the
+     row with the most NULLs among the rows and columns of the tile.
+*/
+void BUILDMST::calculateTile (unsigned int row, unsigned int col, unsigned int size) {
+  NULL_PROFILE profile = NULLS_NONE;
+  unsigned int i;
+  unsigned int row_end = min (row + size, getM ());
+  unsigned int col_end = min (col + size, column_end);
+
+  for (i = row; i < row_end; i++) {
+    profile = max (profile, data.getProfile (i));
+  }
+  for (i = col; i < col_end; i++) {
+    profile = max (profile, data.getProfile (i));
+  }
+
+  switch (profile) {
+    case NULLS_NONE :
+      calculateTilePairs<NULLS_NONE> (row, col, size);
+      break;
+    case NULLS_SPARSE :
+      calculateTilePairs<NULLS_SPARSE> (row, col, size);
+      break;
+    case NULLS_GENERAL :
+      calculateTilePairs<NULLS_GENERAL> (row, col, size);
+      break;
+  }
+
+  return;
+}
+
+
+//!  Calculate the distances within one tile of the distance matrix using the kernels for one NULL profile
+/*!
+     See calculateTile () for the parameters.
+
+     Only pairs above the diagonal (and not among the experiments before
+     first_new) are calculated.
+*/
+template <NULL_PROFILE P>
+void BUILDMST::calculateTilePairs (unsigned int row, unsigned int col, unsigned int size) {
+  double score = 0.0;
+  unsigned int i;
+  unsigned int j;
+  unsigned int row_end = min (row + size, getM ());
+  unsigned int col_end = min (col + size, column_end);
+
+  for (i = row; i < row_end; i++) {
+    //  No self-loops allowed in graph
+    for (j = max (max (col, i + 1), first_new); j < col_end; j++) {
+      //  Spearman pairs with a shared NULL mask are calculated by calculateSpearmanGroups ()
+      if ((getDistance () == DIST_SPEAR) && spearmanGrouped (i, j)) {
+        continue;
+      }
+      if ((!sparse_rows.empty ()) && sparse_rows[i] && sparse_rows[j]) {
+        score = calculateSparse (i, j);
+      }
+      else if ((!quant_rows.empty ()) && quant_rows[i] && quant_rows[j]) {
+        score = calculateQuantized (i, j);
+      }
+      else {
+        score = calculateDistance<P> (i, j);
+      }
+
+      storeDistance (i, j, score);
+    }
   }
 
   return;
 }
 
+
+//!  Calculate the distance between experiments i and j using the chosen distance method
+/*!
+     P is the NULL profile of the two experiments (or worse).
+*/
+template <NULL_PROFILE P>
+double BUILDMST::calculateDistance (unsigned int i, unsigned int j) {
+  double score = 0.0;
+
+  //  All functions return a dissimilarity score
+  switch (getDistance ()) {
+    case DIST_EUC :
+      score = data.getRow (i).simEuc<P> (data.getRow (j));
+      break;
+    case DIST_MAN :
+      score = data.getRow (i).simMan<P> (data.getRow (j));
+      break;
+    case DIST_PEAR :
+      score = data.getRow (i).simPear<P> (data.getRow (j));
+      break;
+    case DIST_SPEAR :
+      if (ranked[i] && ranked[j]) {
+        score = ranks.getRow (i).simPear<NULLS_NONE> (ranks.getRow (j));
+      }
+      else {
+        score = data.getRow (i).simSpear (data.getRow (j));
+      }
+      break;
+    case DIST_COSINE :
+      score = data.getRow (i).simCosine<P> (data.getRow (j), data.getNorm (i), data.getNorm (j));
+      break;
+    case DIST_UNCENTERED :
+      score = data.getRow (i).simUncentered<P> (data.getRow (j), data.getNorm (i), data.getNorm (j));
+      break;
+    case DIST_MI :
+      score = distMutualInfo (&mi_codes[static_cast<size_t> (i) * getN ()], &mi_codes[static_cast<size_t> (j) * getN ()], getN ());
+      break;
+    case DIST_KENDALL :
+      {
+        size_t x = static_cast<size_t> (i) * getN ();
+        size_t y = static_cast<size_t> (j) * getN ();
+        score = distKendall (&kendall_order[x], kendall_count[i], &kendall_ranks[x], &kendall_ranks[y]);
+      }
+      break;
+  }
+
+  return score;
+}
+
+//  Instantiate the distance calculation for each NULL profile
+template double BUILDMST::calculateDistance<NULLS_NONE> (unsigned int i, unsigned int j);
+template double BUILDMST::calculateDistance<NULLS_SPARSE> (unsigned int i, unsigned int j);
+template double BUILDMST::calculateDistance<NULLS_GENERAL> (unsigned int i, unsigned int j);
+
 //!  Initialize the clusters with the data file
 /*!
      Since bottom-up clustering starts off with each object in its own
@@ -154,7 +433,7 @@ void BUILDMST::initializeClusters () {
   CLUSTER c;
 
   for (i = 0; i < M; i++) {
-    c = CLUSTER (i, data[i].getName (), data[i].getColour (), data[i].getShape (), data[i]);
+    c = CLUSTER (i, data.getName (i), data.getColour (i), data.getShape (i));
     clusters.push_back (c);
   }
 
@@ -162,15 +441,43 @@ void BUILDMST::initializeClusters () {
 }
 
 
+//!  Calculate the linkage between clusters i and j
+/*!
+     T is the precision of the distance matrix.
+*/
+template <typename T>
+T BUILDMST::calculateLink (unsigned int i, unsigned int j) {
+  T score = 0;
+  const DISTMATRIX<T> *dist_matrix = &getDistMatrix<T> ();
+
+  switch (getLinkage ()) {
+    case LINK_SINGLE :
+      score = clusters[i].linkSingle (&clusters[j], dist_matrix);
+      break;
+    case LINK_AVERAGE :
+      score = clusters[i].linkAverage (&clusters[j], dist_matrix);
+      break;
+    case LINK_COMPLETE :
+      score = clusters[i].linkComplete (&clusters[j], dist_matrix);
+      break;
+    case LINK_CENTROID :
+      score = static_cast<T> (clusters[i].linkCentroid (&clusters[j], &data, getCentroid ()));
+      break;
+  }
+
+  return score;
+}
+
+
 //!  Calculate the linkage
 /*!
      For a given cluster, the linkage between it and every other cluster
-     is calculated and added into the priority queue.
+     is calculated and added into the priority queue.  T is the precision
+     of the distance matrix.
 */
+template <typename T>
 void BUILDMST::calculateLinkage (CLUSTER &arg) {
-  double score = 0.0;
-  LINK_METHOD linkage = getLinkage ();
-  HEAPNODE heapnode;
+  HEAPNODE<T> heapnode;
 
   unsigned int i = arg.getID ();
   unsigned int j = 0;
@@ -181,22 +488,8 @@ void BUILDMST::calculateLinkage (CLUSTER &arg) {
       continue;
     }
 
-    switch (linkage) {
-      case LINK_SINGLE :
-        score = clusters[i].linkSingle (&clusters[j], dist_matrix);
-        break;
-      case LINK_AVERAGE :
-        score = clusters[i].linkAverage (&clusters[j], dist_matrix);
-        break;
-      case LINK_COMPLETE :
-        score = clusters[i].linkComplete (&clusters[j], dist_matrix);
-        break;
-      case LINK_CENTROID :
-        score = clusters[i].linkCentroid (&clusters[j], &data, getCentroid ());
-        break;
-    }
-    heapnode = HEAPNODE (clusters[i].getID (), clusters[j].getID (), score);
-    pqueue.push (heapnode);
+    heapnode = HEAPNODE<T> (clusters[i].getID (), clusters[j].getID (), calculateLink<T> (i, j));
+    getQueue<T> ().push (heapnode);
   }
 
   return;
@@ -206,13 +499,16 @@ void BUILDMST::calculateLinkage (CLUSTER &arg) {
 //!  Calculate the graph scores
 /*!
      The score for the current graph configuration (based on
-     intra and inter-cluster edge weights) is calculated.
+     intra and inter-cluster edge weights) is calculated.  T is the
+     precision of the distance matrix.
 */
+template <typename T>
 void BUILDMST::calculateScores (SCORE &arg) {
+  const DISTMATRIX<T> *dist_matrix = &getDistMatrix<T> ();
 
   switch (getScoreMethod ()) {
     case SCORE_GAPS     :
-     arg.scoreGaps (getM (), &clusters, dist_matrix, getDebug ());
+      arg.scoreGaps (getM (), &clusters, dist_matrix, getDebug ());
       break;
     case SCORE_ANOVA :
       arg.scoreANOVA (getM (), &clusters, dist_matrix, getDebug ());
@@ -228,6 +524,14 @@ void BUILDMST::calculateScores (SCORE &arg) {
   return;
 }
 
+//  Instantiate the linkage and scoring for each precision of the distance matrix
+template float BUILDMST::calculateLink<float> (unsigned int i, unsigned int j);
+template double BUILDMST::calculateLink<double> (unsigned int i, unsigned int j);
+template void BUILDMST::calculateLinkage<float> (CLUSTER &arg);
+template void BUILDMST::calculateLinkage<double> (CLUSTER &arg);
+template void BUILDMST::calculateScores<float> (SCORE &arg);
+template void BUILDMST::calculateScores<double> (SCORE &arg);
+
 
 //!  Normalize the scores in the scores vector
 /*!
@@ -284,9 +588,15 @@ bool BUILDMST::printScores (string outpath) {
   fout << getM () << endl;
   end = scores.size ();
   for (i = 0; i < end; i++) {
+    //  Experiments renumbered by --reorder are printed with their original numbers, smallest first
+    unsigned int left = getOriginalID (scores[i].getLeft ());
+    unsigned int right = getOriginalID (scores[i].getRight ());
+    if ((scores[i].getLeft () < original_ids.size ()) && (scores[i].getRight () < original_ids.size ()) && (left > right)) {
+      swap (left, right);
+    }
     fout << scores[i].getID () << "\t"
-        << scores[i].getLeft () << "\t"
-        << scores[i].getRight () << "\t"
+        << left << "\t"
+        << right << "\t"
         << scores[i].getScore1 () << "\t"
         << scores[i].getScore2 () << "\t"
         << scores[i].getCombinedScore () << endl;
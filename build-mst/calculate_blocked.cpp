@@ -0,0 +1,311 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_blocked.cpp
+    Additional member functions for BUILDMST class definition
+      Blocked engine for distances between rows without NULLs
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+
+#include <algorithm>  //  min, max
+
+#include <cstdint>  //  uint64_t
+#include <cmath>  //  sqrt
+
+using namespace std;
+
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+/*!
+     For rows without NULLs, both the Euclidean distance and the Pearson
+     correlation can be written in terms of dot products between rows:
+
+       - squared Euclidean distance = ||x||^2 + ||y||^2 - 2 x.y
+       - Pearson correlation = z(x).z(y), where z(x) is x minus its mean,
+         scaled to have a norm of 1
+       - Spearman correlation = the Pearson correlation of the ranks,
+         which are calculated once per row by prepareRanks ()
+       - cosine similarity and uncentered correlation = the same as the
+         Pearson correlation, without subtracting the mean
+
+     The norms (or the standardised rows) are calculated once per row.
+     The dot products are then calculated DOT_BLOCK_ROWS by DOT_BLOCK_ROWS
+     rows at a time by dotBlock (), so that each expression level that is
+     loaded is used DOT_BLOCK_ROWS times.
+
+     Pairs where either row has a NULL are calculated by calculateDistance ()
+     as usual (or by calculateSpearmanGroups () for the Spearman
+     correlation).  Sparse rows (see prepareSparse ()) are left out too,
+     since calculateSparse () does not need to visit all of their columns,
+     and so are the rows quantized by --quantize.  Results can differ from calculateDistance () in the
+     last few bits, so the engine is only used if --blocked is given.
+*/
+
+
+//!  Prepare the rows for the blocked engine
+/*!
+     \return Whether or not the blocked engine can be used with the chosen distance method
+
+     Rows without NULLs are marked.  For the Euclidean distance, the squared
+     norm of each of them is calculated.  For the other distance methods,
+     each of them (or its ranks) is standardised into blocked_rows and its
+     norm before scaling is kept so that rows with no variance can be
+     recognised.  The mean is left in for the cosine and uncentered
+     distances.
+*/
+bool BUILDMST::prepareBlocked () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  unsigned int i = 0;
+  unsigned int j = 0;
+  unsigned int total = 0;
+
+  if ((!getBlocked ()) || (n == 0)) {
+    return false;
+  }
+
+  //  Only distances that can be written in terms of dot products are supported
+  string unsupported;
+  switch (getDistance ()) {
+    case DIST_MAN :
+      unsupported = "the Manhattan distance";
+      break;
+    case DIST_KENDALL :
+      unsupported = "the Kendall correlation";
+      break;
+    case DIST_MI :
+      unsupported = "the mutual information";
+      break;
+    default :
+      break;
+  }
+  if (!unsupported.empty ()) {
+    if (getVerbose ()) {
+      cerr << "==\tWarning:  The blocked engine does not support " << unsupported << "." << endl;
+    }
+    return false;
+  }
+
+  //  Spearman correlation is the Pearson correlation of the ranks
+  const EXPRMATRIX &source = (getDistance () == DIST_SPEAR) ? ranks : data;
+
+  blocked_dense.assign (m, false);
+  blocked_norms.assign (m, 0.0);
+  if (getDistance () != DIST_EUC) {
+    blocked_rows.allocate (m, n);
+  }
+
+  for (i = 0; i < m; i++) {
+    EXPRROW row = source.getRow (i);
+    if (countNonNull (row.getNulls (), row.getNulls (), row.getWords ()) != n) {
+      continue;
+    }
+    if (((!sparse_rows.empty ()) && sparse_rows[i]) || ((!quant_rows.empty ()) && quant_rows[i])) {
+      continue;
+    }
+    blocked_dense[i] = true;
+    total++;
+
+    if (getDistance () == DIST_EUC) {
+      double sum = 0.0;
+      for (j = 0; j < n; j++) {
+        sum += row.getExpr (j) * row.getExpr (j);
+      }
+      blocked_norms[i] = sum;
+    }
+    else {
+      double mean = 0.0;
+      double sum = 0.0;
+      if ((getDistance () == DIST_PEAR) || (getDistance () == DIST_SPEAR)) {
+        for (j = 0; j < n; j++) {
+          mean += row.getExpr (j);
+        }
+        mean = mean / n;
+      }
+      for (j = 0; j < n; j++) {
+        double temp = row.getExpr (j) - mean;
+        sum += temp * temp;
+      }
+      blocked_norms[i] = sqrt (sum);
+
+      //  Rows without any variance are left as zeroes and have a norm of 0
+      for (j = 0; j < n; j++) {
+        if (blocked_norms[i] != 0) {
+          blocked_rows.putExpr (i, j, (row.getExpr (j) - mean) / blocked_norms[i]);
+        }
+        blocked_rows.putNull (i, j, false);
+      }
+    }
+  }
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tRows in blocked engine:" << total << endl;
+  }
+
+  return true;
+}
+
+
+//!  Calculate the distances within one tile of the distance matrix using the blocked engine
+/*!
+     \param row The first row of the tile
+     \param col The first column of the tile
+     \param size The number of rows (and columns) along each side of a tile
+
+     The rows without NULLs in the tile are gathered and processed a block
+     at a time; the last block is filled out by repeating its last row.
+     The remaining pairs are calculated one at a time.  Columns before
+     first_new are left out (see calculateDistances ()).
+*/
+void BUILDMST::calculateTileBlocked (unsigned int row, unsigned int col, unsigned int size) {
+  double score = 0.0;
+  double lanes[DOT_BLOCK_ROWS * DOT_BLOCK_ROWS * SIMD_LANES];
+  const double *x[DOT_BLOCK_ROWS];
+  const double *y[DOT_BLOCK_ROWS];
+  unsigned int i;
+  unsigned int j;
+  unsigned int a;
+  unsigned int b;
+  unsigned int r;
+  unsigned int c;
+  unsigned int row_end = min (row + size, getM ());
+  unsigned int col_end = min (col + size, column_end);
+  const EXPRMATRIX &source = (getDistance () == DIST_EUC) ? data : blocked_rows;
+  vector<unsigned int> rows;
+  vector<unsigned int> cols;
+
+  for (i = row; i < row_end; i++) {
+    if (blocked_dense[i]) {
+      rows.push_back (i);
+    }
+  }
+  for (j = max (col, first_new); j < col_end; j++) {
+    if (blocked_dense[j]) {
+      cols.push_back (j);
+    }
+  }
+
+  for (a = 0; a < rows.size (); a += DOT_BLOCK_ROWS) {
+    for (b = 0; b < cols.size (); b += DOT_BLOCK_ROWS) {
+      //  Skip blocks that are entirely on or below the diagonal
+      if (cols[min (b + DOT_BLOCK_ROWS, static_cast<unsigned int> (cols.size ())) - 1] <= rows[a]) {
+        continue;
+      }
+
+      for (r = 0; r < DOT_BLOCK_ROWS; r++) {
+        x[r] = source.getRow (rows[min (a + r, static_cast<unsigned int> (rows.size ()) - 1)]).getExprs ();
+        y[r] = source.getRow (cols[min (b + r, static_cast<unsigned int> (cols.size ()) - 1)]).getExprs ();
+      }
+      dotBlock (x, y, getN (), lanes);
+
+      for (r = 0; (r < DOT_BLOCK_ROWS) && (a + r < rows.size ()); r++) {
+        for (c = 0; (c < DOT_BLOCK_ROWS) && (b + c < cols.size ()); c++) {
+          i = rows[a + r];
+          j = cols[b + c];
+          //  No self-loops allowed in graph
+          if (j <= i) {
+            continue;
+          }
+
+          double dot = sumLanes (lanes + (r * DOT_BLOCK_ROWS + c) * SIMD_LANES);
+          if (getDistance () == DIST_EUC) {
+            //  Rounding can make the squared distance slightly negative
+            score = sqrt (max (0.0, blocked_norms[i] + blocked_norms[j] - 2 * dot));
+          }
+          else if ((blocked_norms[i] == 0) || (blocked_norms[j] == 0)) {
+            //  Maximum possible distance
+            score = 2.0;
+          }
+          else {
+            score = 1 - dot;
+          }
+
+          storeDistance (i, j, score);
+        }
+      }
+    }
+  }
+
+  //  Pairs with NULLs (or sparse or quantized pairs)
+  for (i = row; i < row_end; i++) {
+    for (j = max (max (col, i + 1), first_new); j < col_end; j++) {
+      if (blocked_dense[i] && blocked_dense[j]) {
+        continue;
+      }
+      //  Spearman pairs with a shared NULL mask are calculated by calculateSpearmanGroups ()
+      if ((getDistance () == DIST_SPEAR) && spearmanGrouped (i, j)) {
+        continue;
+      }
+      if ((!sparse_rows.empty ()) && sparse_rows[i] && sparse_rows[j]) {
+        score = calculateSparse (i, j);
+      }
+      else if ((!quant_rows.empty ()) && quant_rows[i] && quant_rows[j]) {
+        score = calculateQuantized (i, j);
+      }
+      else {
+        score = calculateDistance (i, j);
+      }
+      storeDistance (i, j, score);
+    }
+  }
+
+  return;
+}
+
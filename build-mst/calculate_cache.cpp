@@ -0,0 +1,368 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_cache.cpp
+    Additional member functions for BUILDMST class definition
+      Distance matrix in memory, in a file, or in the cache
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw, setfill
+#include <fstream>  //  ifstream
+#include <sstream>  //  ostringstream
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+#include <algorithm>  //  equal
+
+#include <cstdint>  //  uint64_t
+#include <cstdlib>  //  exit, EXIT_FAILURE
+
+#include <sys/stat.h>  //  mkdir
+
+using namespace std;
+
+#include "global_defn.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+/*!
+     The distance matrix does not depend on the linkage method, the scoring
+     method or the centroid distance method.  So, when --cache-dir is given,
+     the matrix is calculated into a file in the cache directory and later
+     runs on the same microarray file map that file instead of calculating
+     the matrix again.
+
+     A cache entry is named after the hash of the microarray file, the
+     distance method and the precision.  The header of the file (see
+     DISTMATRIX::makeHeader ()) is tagged with the hash, the distance method,
+     the number of columns and whether or not the blocked engine was used;
+     the number of experiments and the precision are in the header already.
+     The hash of each row is kept at the end of the file.  An entry is only
+     reused if all of them match.
+
+     With --extend, the entry for an earlier version of the microarray file
+     is used to create the entry for the current one.  If every row of the
+     earlier version is unchanged at the start of the current one, then its
+     distances are copied and only the pairs involving the rows appended
+     since are calculated.
+*/
+
+
+//!  Add bytes to a 64-bit FNV-1a hash
+/*!
+     \param bytes The bytes
+     \param len Number of bytes
+     \param hash The hash so far (HASH_FNV_OFFSET to start)
+     \return The hash including the bytes
+*/
+static uint64_t hashBytes (const char *bytes, size_t len, uint64_t hash) {
+  for (size_t k = 0; k < len; k++) {
+    hash ^= static_cast<unsigned char> (bytes[k]);
+    hash *= HASH_FNV_PRIME;
+  }
+
+  return hash;
+}
+
+
+//!  Calculate the 64-bit FNV-1a hash of the contents of a file
+/*!
+     \param fn Name of the file
+     \param hash The hash
+     \return Whether or not the file could be read
+*/
+static bool hashFile (string fn, uint64_t &hash) {
+  char buffer[65536];
+
+  ifstream fp (fn.c_str (), ios::in | ios::binary);
+  if (!fp) {
+    return false;
+  }
+
+  hash = HASH_FNV_OFFSET;
+  while (fp) {
+    fp.read (buffer, sizeof (buffer));
+    hash = hashBytes (buffer, fp.gcount (), hash);
+  }
+
+  return true;
+}
+
+
+//!  Calculate the 64-bit FNV-1a hash of a row of the microarray data
+/*!
+     \param data The microarray data
+     \param i The row
+     \return The hash of the name, the expression levels and the NULL flags of the row
+*/
+static uint64_t hashRow (const EXPRMATRIX &data, unsigned int i) {
+  EXPRROW row = data.getRow (i);
+  string name = data.getName (i);
+  uint64_t hash = HASH_FNV_OFFSET;
+
+  hash = hashBytes (name.c_str (), name.length () + 1, hash);
+  hash = hashBytes (reinterpret_cast<const char*> (row.getExprs ()), row.getN () * sizeof (double), hash);
+  hash = hashBytes (reinterpret_cast<const char*> (row.getNulls ()), row.getWords () * sizeof (uint64_t), hash);
+
+  return hash;
+}
+
+
+//!  Allocate the distance matrix with the chosen precision
+/*!
+     \return Whether or not the matrix was found in the cache (see allocateDistances ())
+*/
+bool BUILDMST::openDistances () {
+  if (getPrecision () == PREC_FLOAT) {
+    return allocateDistances<float> ();
+  }
+
+  return allocateDistances<double> ();
+}
+
+
+//!  Allocate the distance matrix
+/*!
+     \return Whether or not the matrix was found in the cache, in which case its distances do not have to be calculated
+
+     T is the precision of the distance matrix.  Without --cache-dir, the
+     matrix is kept in memory or, with --matrix-file, in a memory-mapped
+     file.  With --cache-dir, a matching cache entry is mapped if there
+     is one; otherwise, a new entry is created for the distances to be
+     calculated into (see extendDistances () for --extend).
+*/
+template <typename T>
+bool BUILDMST::allocateDistances () {
+  DISTMATRIX<T> &dist_matrix = getDistMatrix<T> ();
+  unsigned int m = getM ();
+  unsigned int i = 0;
+  uint64_t hash = 0;
+  vector<uint64_t> tag;
+  vector<uint64_t> rows;
+
+  first_new = 0;
+  if (getCacheDir ().empty ()) {
+    if (getMatrixFn ().empty ()) {
+      dist_matrix.allocate (m);
+    }
+    else {
+      dist_matrix.allocateFile (m, getMatrixFn (), tag, rows);
+    }
+    return false;
+  }
+
+  if (!hashFile (getMicroarrayFn (), hash)) {
+    cerr << "==\tError:  Input file " << getMicroarrayFn () << " could not be hashed!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  tag.push_back (hash);
+  tag.push_back (getDistance ());
+  tag.push_back (getN ());
+  tag.push_back (getBlocked () ? 1 : 0);
+  if (getTopVariance () != 0) {
+    tag.push_back (getTopVariance ());
+  }
+  if (getImpute () != IMPUTE_NONE) {
+    tag.push_back (getImpute ());
+  }
+  if (getQuantize () != 0) {
+    tag.push_back (getQuantize ());
+  }
+  if (getReorder ()) {
+    tag.push_back (1);
+  }
+  if (getSketchDim () != 0) {
+    tag.push_back (getSketchDim ());
+    tag.push_back (getSketchSeed ());
+  }
+  else if (getPcaDim () != 0) {
+    tag.push_back (getPcaDim ());
+  }
+  for (i = 0; i < m; i++) {
+    rows.push_back (hashRow (data, i));
+  }
+
+  string fn = cacheFilename (hash);
+  if (dist_matrix.mapFile (m, fn, tag, rows)) {
+    if (getVerbose ()) {
+      cerr << left << setw (VERBOSE_WIDTH) << "==\tReused cached distances:" << fn << endl;
+    }
+    return true;
+  }
+
+  //  The directory may exist already
+  mkdir (getCacheDir ().c_str (), 0755);
+  dist_matrix.allocateFile (m, fn, tag, rows);
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tCaching distances in:" << fn << endl;
+  }
+
+  if (!getExtendFn ().empty ()) {
+    extendDistances<T> (tag, rows);
+  }
+
+  return false;
+}
+
+
+//!  Copy the distances between the unchanged rows from the cache entry given with --extend
+/*!
+     \param tag The tag of the new cache entry
+     \param rows The hashes of the rows of the new cache entry
+
+     T is the precision of the distance matrix.  The earlier entry must
+     have the same precision, the same tag apart from the hash of the
+     microarray file, and no more rows; the hash of each of its rows must
+     match the hash of the same row now.  If so, its distances are copied
+     and first_new is set to its number of rows, so that only the pairs
+     involving the new rows are calculated.  Otherwise, a warning is
+     printed and every distance is calculated.
+*/
+template <typename T>
+void BUILDMST::extendDistances (const vector<uint64_t> &tag, const vector<uint64_t> &rows) {
+  DISTMATRIX<T> previous;
+  unsigned int previous_m = 0;
+  vector<uint64_t> previous_tag;
+  vector<uint64_t> previous_rows;
+
+  if (!DISTMATRIX<T>::readHeader (getExtendFn (), previous_m, previous_tag, previous_rows)) {
+    cerr << "==\tWarning:  " << getExtendFn () << " is not a cached distance matrix with this precision; calculating every distance." << endl;
+    return;
+  }
+  if ((previous_tag.size () != tag.size ()) || (!equal (tag.begin () + 1, tag.end (), previous_tag.begin () + 1))) {
+    cerr << "==\tWarning:  " << getExtendFn () << " was calculated with other settings; calculating every distance." << endl;
+    return;
+  }
+  if ((previous_m > rows.size ()) || (previous_rows.size () != previous_m) ||
+      (!equal (previous_rows.begin (), previous_rows.end (), rows.begin ()))) {
+    cerr << "==\tWarning:  The rows of " << getExtendFn () << " have changed; calculating every distance." << endl;
+    return;
+  }
+  if (!previous.mapFile (previous_m, getExtendFn (), previous_tag, previous_rows)) {
+    cerr << "==\tWarning:  " << getExtendFn () << " could not be mapped; calculating every distance." << endl;
+    return;
+  }
+
+  getDistMatrix<T> ().copy (previous);
+  first_new = previous_m;
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tRows reused from cache:" << previous_m << " (from " << getExtendFn () << ")" << endl;
+  }
+
+  return;
+}
+
+
+//!  The name of the cache entry for a microarray file
+/*!
+     \param hash The hash of the microarray file
+     \return The name of the file, including the cache directory
+*/
+string BUILDMST::cacheFilename (uint64_t hash) const {
+  ostringstream fn;
+
+  fn << getCacheDir () << hex << setw (16) << setfill ('0') << hash << dec;
+  switch (getDistance ()) {
+    case DIST_EUC   : fn << ".euclidean";
+      break;
+    case DIST_MAN   : fn << ".manhattan";
+      break;
+    case DIST_PEAR  : fn << ".pearson";
+      break;
+    case DIST_SPEAR : fn << ".spearman";
+      break;
+    case DIST_KENDALL : fn << ".kendall";
+      break;
+    case DIST_COSINE : fn << ".cosine";
+      break;
+    case DIST_UNCENTERED : fn << ".uncentered";
+      break;
+    case DIST_MI : fn << ".mi";
+      break;
+  }
+  if (getTopVariance () != 0) {
+    fn << ".top" << getTopVariance ();
+  }
+  switch (getImpute ()) {
+    case IMPUTE_NONE :
+      break;
+    case IMPUTE_ROWMEAN : fn << ".rowmean";
+      break;
+    case IMPUTE_KNN : fn << ".knn";
+      break;
+  }
+  if (getQuantize () != 0) {
+    fn << ".q" << getQuantize ();
+  }
+  if (getReorder ()) {
+    fn << ".reorder";
+  }
+  if (getSketchDim () != 0) {
+    fn << ".sketch" << getSketchDim ();
+  }
+  else if (getPcaDim () != 0) {
+    fn << ".pca" << getPcaDim ();
+  }
+  fn << ((getPrecision () == PREC_FLOAT) ? ".float" : ".double");
+  if (getBlocked ()) {
+    fn << ".blocked";
+  }
+  fn << DIST_CACHE_FILE_EXTENSION;
+
+  return fn.str ();
+}
+
+//  Instantiate the allocation for each precision of the distance matrix
+template bool BUILDMST::allocateDistances<float> ();
+template bool BUILDMST::allocateDistances<double> ();
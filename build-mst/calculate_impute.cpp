@@ -0,0 +1,308 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_impute.cpp
+    Additional member functions for BUILDMST class definition
+      Filling in NULLs for --impute
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+#include <utility>  //  pair
+
+#include <algorithm>  //  min
+
+#include <cstdint>  //  uint64_t
+
+using namespace std;
+
+#include "BuildMSTConfig.hpp"
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+/*!
+     With --impute, every NULL is replaced by a value before any distances
+     are calculated, so that all rows have the NULLS_NONE profile and the
+     fastest distance kernels (and the blocked engine) can be used:
+
+       - rowmean:  the mean of the non-null values of the same row
+       - knn:  the mean of the values in the same column of the
+         IMPUTE_KNN_NEIGHBOURS nearest rows, where the Euclidean distance
+         between rows is measured over the columns without any NULLs
+
+     For knn, a value which is NULL in all of the neighbours falls back to
+     the row mean, as does every value if there is only one row.  A row
+     which has no values at all keeps its NULLs, since there is nothing to
+     base a value on.
+*/
+
+
+//!  Find the nearest rows to each row with NULLs
+/*!
+     \param complete The columns of the data without any NULLs
+     \param targets The rows whose neighbours are needed
+     \param k The number of neighbours of each row
+     \param neighbours Filled with the neighbours of each of the targets
+     \param threads The number of threads
+
+     Squared Euclidean distances are found from the norms and the dot
+     products, which are calculated DOT_BLOCK_ROWS by DOT_BLOCK_ROWS rows at
+     a time by dotBlock ().  Each thread takes a block of targets and keeps
+     a heap of at most k neighbours for each of them, so no two threads
+     write to the same heap.  Ties go to the earlier row.
+*/
+static void findNeighbours (const EXPRMATRIX &complete, const vector<unsigned int> &targets, unsigned int k, vector<vector<unsigned int> > &neighbours, unsigned int threads) {
+  unsigned int m = complete.getM ();
+  unsigned int n = complete.getN ();
+  unsigned int t = targets.size ();
+  vector<double> norms (m, 0.0);
+  int a = 0;
+
+  for (unsigned int i = 0; i < m; i++) {
+    const double *row = complete.getRow (i).getExprs ();
+    for (unsigned int j = 0; j < n; j++) {
+      norms[i] += row[j] * row[j];
+    }
+  }
+
+  neighbours.assign (t, vector<unsigned int> ());
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads)
+#endif
+  for (a = 0; a < static_cast<int> (t); a += DOT_BLOCK_ROWS) {
+    double lanes[DOT_BLOCK_ROWS * DOT_BLOCK_ROWS * SIMD_LANES];
+    const double *x[DOT_BLOCK_ROWS];
+    const double *y[DOT_BLOCK_ROWS];
+    priority_queue<pair<double, unsigned int> > heaps[DOT_BLOCK_ROWS];
+    unsigned int r = 0;
+    unsigned int c = 0;
+
+    for (r = 0; r < DOT_BLOCK_ROWS; r++) {
+      x[r] = complete.getRow (targets[min (a + r, t - 1)]).getExprs ();
+    }
+    for (unsigned int b = 0; b < m; b += DOT_BLOCK_ROWS) {
+      for (c = 0; c < DOT_BLOCK_ROWS; c++) {
+        y[c] = complete.getRow (min (b + c, m - 1)).getExprs ();
+      }
+      dotBlock (x, y, n, lanes);
+
+      for (r = 0; (r < DOT_BLOCK_ROWS) && (a + r < t); r++) {
+        unsigned int i = targets[a + r];
+        for (c = 0; (c < DOT_BLOCK_ROWS) && (b + c < m); c++) {
+          unsigned int j = b + c;
+          if (i == j) {
+            continue;
+          }
+          double dist = norms[i] + norms[j] - 2 * sumLanes (lanes + (r * DOT_BLOCK_ROWS + c) * SIMD_LANES);
+          if (heaps[r].size () < k) {
+            heaps[r].push (make_pair (dist, j));
+          }
+          else if (make_pair (dist, j) < heaps[r].top ()) {
+            heaps[r].pop ();
+            heaps[r].push (make_pair (dist, j));
+          }
+        }
+      }
+    }
+
+    for (r = 0; (r < DOT_BLOCK_ROWS) && (a + r < t); r++) {
+      while (!heaps[r].empty ()) {
+        neighbours[a + r].push_back (heaps[r].top ().second);
+        heaps[r].pop ();
+      }
+    }
+  }
+}
+
+
+//!  Replace every NULL in the data by an imputed value
+/*!
+     The number of values imputed is reported if --verbose is given.
+*/
+void BUILDMST::imputeData () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  unsigned int i = 0;
+  unsigned int j = 0;
+  unsigned int imputed = 0;
+  unsigned int by_mean = 0;
+  unsigned int empty = 0;
+  vector<unsigned int> targets;
+
+  for (i = 0; i < m; i++) {
+    EXPRROW row = data.getRow (i);
+    if (countNonNull (row.getNulls (), row.getNulls (), row.getWords ()) != n) {
+      targets.push_back (i);
+    }
+  }
+
+  //  The NULL columns of each target and the values imputed for them
+  vector<vector<pair<unsigned int, double> > > values (targets.size ());
+  for (unsigned int t = 0; t < targets.size (); t++) {
+    for (j = 0; j < n; j++) {
+      if (data.isNull (targets[t], j)) {
+        values[t].push_back (make_pair (j, 0.0));
+      }
+    }
+  }
+  vector<vector<bool> > found (targets.size ());
+  for (unsigned int t = 0; t < targets.size (); t++) {
+    found[t].assign (values[t].size (), false);
+  }
+
+  if ((getImpute () == IMPUTE_KNN) && (!targets.empty ())) {
+    vector<unsigned int> columns;
+    for (j = 0; j < n; j++) {
+      for (i = 0; (i < m) && (!data.isNull (i, j)); i++) {
+      }
+      if (i == m) {
+        columns.push_back (j);
+      }
+    }
+
+    //  A single row has no neighbours
+    unsigned int k = min (static_cast<unsigned int> (IMPUTE_KNN_NEIGHBOURS), m - 1);
+
+    if (columns.empty ()) {
+      cerr << "==\tWarning:  No column is without NULLs; --impute knn falls back to the row means." << endl;
+    }
+    else if (k != 0) {
+      EXPRMATRIX complete;
+      complete.allocate (m, columns.size ());
+      for (i = 0; i < m; i++) {
+        for (j = 0; j < columns.size (); j++) {
+          complete.putExpr (i, j, data.getExpr (i, columns[j]));
+          complete.putNull (i, j, false);
+        }
+      }
+
+      vector<vector<unsigned int> > neighbours;
+      findNeighbours (complete, targets, k, neighbours, getThreads ());
+
+      for (unsigned int t = 0; t < targets.size (); t++) {
+        for (unsigned int v = 0; v < values[t].size (); v++) {
+          unsigned int col = values[t][v].first;
+          unsigned int count = 0;
+          double sum = 0.0;
+          for (unsigned int p = 0; p < neighbours[t].size (); p++) {
+            if (!data.isNull (neighbours[t][p], col)) {
+              sum += data.getExpr (neighbours[t][p], col);
+              count++;
+            }
+          }
+          if (count != 0) {
+            values[t][v].second = sum / count;
+            found[t][v] = true;
+          }
+        }
+      }
+    }
+  }
+
+  //  Row means, for --impute rowmean and for whatever knn could not fill in
+  for (unsigned int t = 0; t < targets.size (); t++) {
+    unsigned int count = 0;
+    double mean = 0.0;
+    for (j = 0; j < n; j++) {
+      if (!data.isNull (targets[t], j)) {
+        mean += data.getExpr (targets[t], j);
+        count++;
+      }
+    }
+    //  Rows without any values keep their NULLs
+    if (count == 0) {
+      values[t].clear ();
+      empty++;
+      continue;
+    }
+    mean = mean / count;
+
+    for (unsigned int v = 0; v < values[t].size (); v++) {
+      if (!found[t][v]) {
+        values[t][v].second = mean;
+        by_mean++;
+      }
+    }
+  }
+
+  //  The values are only stored once all of them have been found, so
+  //    that imputed values are never used to impute others
+  for (unsigned int t = 0; t < targets.size (); t++) {
+    for (unsigned int v = 0; v < values[t].size (); v++) {
+      data.putExpr (targets[t], values[t][v].first, values[t][v].second);
+      data.putNull (targets[t], values[t][v].first, false);
+      imputed++;
+    }
+  }
+  data.profileNulls ();
+  data.calculateNorms ();
+
+  if (empty != 0) {
+    cerr << "==\tWarning:  " << empty << " row(s) without any values are left with their NULLs by --impute." << endl;
+  }
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tValues imputed:" << imputed << " of " << static_cast<uint64_t> (m) * n;
+    if (getImpute () == IMPUTE_KNN) {
+      cerr << " (" << by_mean << " by row mean)";
+    }
+    cerr << endl;
+  }
+
+  return;
+}
+
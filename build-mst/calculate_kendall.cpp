@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_kendall.cpp
+    Additional member functions for BUILDMST class definition
+      Functions for sharing Kendall presorting between pairs
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+
+#include <cstdint>  //  uint64_t
+
+using namespace std;
+
+#include "BuildMSTConfig.hpp"
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect_kendall.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+
+//!  Presort every row for the Kendall correlation
+/*!
+     The order of a row's columns by expression level does not depend on
+     the other row in a pair, so it is calculated once per row here and
+     reused for all of its partners (see distKendall ()).  Unlike the
+     Spearman ranks, rows with NULLs are presorted as well, since the
+     NULLs of the other row are skipped while walking through the order.
+*/
+void BUILDMST::prepareKendall () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  int i = 0;
+
+  kendall_order.assign (static_cast<size_t> (m) * n, 0);
+  kendall_ranks.assign (static_cast<size_t> (m) * n, 0);
+  kendall_count.assign (m, 0);
+  if (n == 0) {
+    return;
+  }
+
+  //  Each thread presorts whole rows, so no two threads write to the same row
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (getThreads ())
+#endif
+  for (i = 0; i < static_cast<int> (m); i++) {
+    size_t offset = static_cast<size_t> (i) * n;
+    kendall_count[i] = presortKendall (data.getRow (i), &kendall_order[offset], &kendall_ranks[offset]);
+  }
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tRows presorted in advance:" << m << endl;
+  }
+
+  return;
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_mi.cpp
+    Additional member functions for BUILDMST class definition
+      Functions for discretising rows for the mutual information
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+
+#include <cstdint>  //  uint8_t, uint64_t
+
+using namespace std;
+
+#include "BuildMSTConfig.hpp"
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect_mi.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+
+//!  Discretise every row for the mutual information
+/*!
+     The bins of a row do not depend on the other row in a pair, so each
+     row is discretised once here into one byte per column and the codes
+     are reused for all of its partners (see distMutualInfo ()).
+*/
+void BUILDMST::prepareMutualInfo () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  int i = 0;
+
+  mi_codes.assign (static_cast<size_t> (m) * n + 1, MI_NULL_CODE);
+
+  //  Each thread discretises whole rows, so no two threads write to the same row
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (getThreads ())
+#endif
+  for (i = 0; i < static_cast<int> (m); i++) {
+    binMutualInfo (data.getRow (i), &mi_codes[static_cast<size_t> (i) * n]);
+  }
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tRows discretised in advance:" << m << " (" << MI_BINS << " bins)" << endl;
+  }
+
+  return;
+}
@@ -0,0 +1,403 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_pca.cpp
+    Additional member functions for BUILDMST class definition
+      Randomized principal component analysis for --pca
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw, setprecision
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+#include <random>  //  mt19937_64, normal_distribution
+
+#include <algorithm>  //  min, swap, sort
+
+#include <cstdint>  //  uint64_t
+#include <cmath>  //  sqrt, fabs
+
+using namespace std;
+
+#include "BuildMSTConfig.hpp"
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+/*!
+     With --pca K, the experiments are replaced by their scores on the
+     first K principal components before any distances are calculated.
+     The columns are centred (with NULLs replaced by the column mean) and
+     a truncated SVD of the centred M by N matrix A is found with the
+     randomized range finder of Halko, Martinsson and Tropp:
+
+       1.  Y = A W for a random Gaussian N by L matrix W, where
+           L = K + PCA_OVERSAMPLE
+       2.  PCA_POWER_ITERATIONS times, Y = A (A' Y), orthonormalising in
+           between, so that the spectrum decays faster
+       3.  Q = an orthonormal basis of Y, and B' = A' Q
+       4.  the eigen-decomposition of B B' = U S^2 U' (L by L) by Jacobi
+           rotations, so that the scores are A V = Q U S
+
+     Only products with A involve N, and they are done a block of rows
+     (or columns) at a time on all threads.  No LAPACK is needed.
+*/
+
+
+//!  Multiply the centred data by a dense matrix:  Y = A X
+/*!
+     \param a The centred data, with no NULLs
+     \param x An N by L matrix (row-major)
+     \param l The number of columns of X
+     \param y Filled with the M by L product (row-major)
+     \param threads The number of threads
+
+     Each thread calculates whole rows of Y.
+*/
+static void multiplyRows (const EXPRMATRIX &a, const vector<double> &x, unsigned int l, vector<double> &y, unsigned int threads) {
+  unsigned int m = a.getM ();
+  unsigned int n = a.getN ();
+  int i = 0;
+
+  y.assign (static_cast<size_t> (m) * l, 0.0);
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 4) num_threads (threads)
+#endif
+  for (i = 0; i < static_cast<int> (m); i++) {
+    const double *row = a.getRow (i).getExprs ();
+    double *out = &y[static_cast<size_t> (i) * l];
+    for (unsigned int j = 0; j < n; j++) {
+      double value = row[j];
+      const double *in = &x[static_cast<size_t> (j) * l];
+      for (unsigned int c = 0; c < l; c++) {
+        out[c] += value * in[c];
+      }
+    }
+  }
+}
+
+
+//!  Multiply the transpose of the centred data by a dense matrix:  Z = A' Y
+/*!
+     See multiplyRows () for the parameters; Y is M by L and Z is N by L.
+     The columns of A are split into blocks of PCA_BLOCK_COLUMNS and each
+     thread calculates the rows of Z for whole blocks, so that no two
+     threads write to the same row.
+*/
+static void multiplyColumns (const EXPRMATRIX &a, const vector<double> &y, unsigned int l, vector<double> &z, unsigned int threads) {
+  unsigned int m = a.getM ();
+  unsigned int n = a.getN ();
+  int b = 0;
+  int blocks = static_cast<int> ((n + PCA_BLOCK_COLUMNS - 1) / PCA_BLOCK_COLUMNS);
+
+  z.assign (static_cast<size_t> (n) * l, 0.0);
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads)
+#endif
+  for (b = 0; b < blocks; b++) {
+    unsigned int start = b * PCA_BLOCK_COLUMNS;
+    unsigned int end = min (start + PCA_BLOCK_COLUMNS, n);
+    for (unsigned int i = 0; i < m; i++) {
+      const double *row = a.getRow (i).getExprs ();
+      const double *in = &y[static_cast<size_t> (i) * l];
+      for (unsigned int j = start; j < end; j++) {
+        double value = row[j];
+        double *out = &z[static_cast<size_t> (j) * l];
+        for (unsigned int c = 0; c < l; c++) {
+          out[c] += value * in[c];
+        }
+      }
+    }
+  }
+}
+
+
+//!  Orthonormalise the columns of a row-major matrix in place
+/*!
+     \param y The matrix
+     \param rows The number of rows
+     \param l The number of columns
+
+     Modified Gram-Schmidt, applied twice for stability.  A column that is
+     (numerically) dependent on the earlier ones is set to zero.
+*/
+static void orthonormalise (vector<double> &y, unsigned int rows, unsigned int l) {
+  for (unsigned int c = 0; c < l; c++) {
+    double before = 0.0;
+    for (unsigned int i = 0; i < rows; i++) {
+      before += y[static_cast<size_t> (i) * l + c] * y[static_cast<size_t> (i) * l + c];
+    }
+
+    for (unsigned int pass = 0; pass < 2; pass++) {
+      for (unsigned int p = 0; p < c; p++) {
+        double dot = 0.0;
+        for (unsigned int i = 0; i < rows; i++) {
+          dot += y[static_cast<size_t> (i) * l + c] * y[static_cast<size_t> (i) * l + p];
+        }
+        for (unsigned int i = 0; i < rows; i++) {
+          y[static_cast<size_t> (i) * l + c] -= dot * y[static_cast<size_t> (i) * l + p];
+        }
+      }
+    }
+
+    double norm = 0.0;
+    for (unsigned int i = 0; i < rows; i++) {
+      norm += y[static_cast<size_t> (i) * l + c] * y[static_cast<size_t> (i) * l + c];
+    }
+    norm = sqrt (norm);
+    double scale = ((norm == 0) || (norm * norm <= PCA_RANK_TOLERANCE * before)) ? 0.0 : 1 / norm;
+    for (unsigned int i = 0; i < rows; i++) {
+      y[static_cast<size_t> (i) * l + c] *= scale;
+    }
+  }
+}
+
+
+//!  Find the eigenvalues and eigenvectors of a symmetric matrix by cyclic Jacobi rotations
+/*!
+     \param c The L by L matrix (row-major); destroyed
+     \param l The size of the matrix
+     \param values Filled with the eigenvalues, largest first
+     \param vectors Filled with the eigenvectors, as columns in the same order (row-major)
+*/
+static void eigenSymmetric (vector<double> &c, unsigned int l, vector<double> &values, vector<double> &vectors) {
+  vector<double> v (static_cast<size_t> (l) * l, 0.0);
+  unsigned int p = 0;
+  unsigned int q = 0;
+  unsigned int k = 0;
+
+  for (p = 0; p < l; p++) {
+    v[p * l + p] = 1.0;
+  }
+
+  for (unsigned int sweep = 0; sweep < PCA_JACOBI_SWEEPS; sweep++) {
+    double off = 0.0;
+    double diag = 0.0;
+    for (p = 0; p < l; p++) {
+      diag += c[p * l + p] * c[p * l + p];
+      for (q = p + 1; q < l; q++) {
+        off += c[p * l + q] * c[p * l + q];
+      }
+    }
+    if (off <= PCA_RANK_TOLERANCE * PCA_RANK_TOLERANCE * diag) {
+      break;
+    }
+
+    for (p = 0; p < l; p++) {
+      for (q = p + 1; q < l; q++) {
+        double apq = c[p * l + q];
+        if (apq == 0) {
+          continue;
+        }
+        double theta = (c[q * l + q] - c[p * l + p]) / (2 * apq);
+        double t = ((theta >= 0) ? 1.0 : -1.0) / (fabs (theta) + sqrt (theta * theta + 1));
+        double cs = 1 / sqrt (t * t + 1);
+        double sn = t * cs;
+
+        for (k = 0; k < l; k++) {
+          double akp = c[k * l + p];
+          double akq = c[k * l + q];
+          c[k * l + p] = cs * akp - sn * akq;
+          c[k * l + q] = sn * akp + cs * akq;
+        }
+        for (k = 0; k < l; k++) {
+          double apk = c[p * l + k];
+          double aqk = c[q * l + k];
+          c[p * l + k] = cs * apk - sn * aqk;
+          c[q * l + k] = sn * apk + cs * aqk;
+        }
+        for (k = 0; k < l; k++) {
+          double vkp = v[k * l + p];
+          double vkq = v[k * l + q];
+          v[k * l + p] = cs * vkp - sn * vkq;
+          v[k * l + q] = sn * vkp + cs * vkq;
+        }
+      }
+    }
+  }
+
+  //  Sort by eigenvalue, largest first
+  vector<pair<double, unsigned int> > order;
+  for (p = 0; p < l; p++) {
+    order.push_back (make_pair (-c[p * l + p], p));
+  }
+  sort (order.begin (), order.end ());
+
+  values.assign (l, 0.0);
+  vectors.assign (static_cast<size_t> (l) * l, 0.0);
+  for (q = 0; q < l; q++) {
+    values[q] = -order[q].first;
+    for (p = 0; p < l; p++) {
+      vectors[p * l + q] = v[p * l + order[q].second];
+    }
+  }
+}
+
+
+//!  Replace the experiments by their scores on the first --pca principal components
+/*!
+     Nothing is done if K is not smaller than both the number of rows and
+     the number of columns.  The scores have no NULLs.
+*/
+void BUILDMST::reduceData () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  unsigned int k = getPcaDim ();
+  unsigned int threads = getThreads ();
+  unsigned int i = 0;
+  unsigned int j = 0;
+  unsigned int c = 0;
+
+  if ((k >= n) || (k >= m)) {
+    if (getVerbose ()) {
+      cerr << "==\tWarning:  --pca is not smaller than the number of rows and columns; the rows are not reduced." << endl;
+    }
+    setPcaDim (0);
+    return;
+  }
+  unsigned int l = min (k + PCA_OVERSAMPLE, min (m, n));
+
+  //  Centre each column in place, with NULLs replaced by the column mean
+  double total = 0.0;
+  for (j = 0; j < n; j++) {
+    double sum = 0.0;
+    unsigned int count = 0;
+    for (i = 0; i < m; i++) {
+      if (!data.isNull (i, j)) {
+        sum += data.getExpr (i, j);
+        count++;
+      }
+    }
+    double mean = (count == 0) ? 0.0 : sum / count;
+    for (i = 0; i < m; i++) {
+      double value = data.isNull (i, j) ? 0.0 : data.getExpr (i, j) - mean;
+      data.putExpr (i, j, value);
+      data.putNull (i, j, false);
+      total += value * value;
+    }
+  }
+
+  //  Random Gaussian test matrix
+  mt19937_64 generator (PCA_SEED);
+  normal_distribution<double> gaussian (0.0, 1.0);
+  vector<double> w (static_cast<size_t> (n) * l);
+  for (size_t e = 0; e < w.size (); e++) {
+    w[e] = gaussian (generator);
+  }
+
+  //  Range finder with power iterations
+  vector<double> y;
+  vector<double> z;
+  multiplyRows (data, w, l, y, threads);
+  w.clear ();
+  for (unsigned int iter = 0; iter < PCA_POWER_ITERATIONS; iter++) {
+    orthonormalise (y, m, l);
+    multiplyColumns (data, y, l, z, threads);
+    orthonormalise (z, n, l);
+    multiplyRows (data, z, l, y, threads);
+  }
+  orthonormalise (y, m, l);
+
+  //  B' = A' Q, then B B' = (B')' B'
+  multiplyColumns (data, y, l, z, threads);
+  vector<double> bbt (static_cast<size_t> (l) * l, 0.0);
+  for (j = 0; j < n; j++) {
+    const double *row = &z[static_cast<size_t> (j) * l];
+    for (unsigned int p = 0; p < l; p++) {
+      for (unsigned int q = 0; q < l; q++) {
+        bbt[p * l + q] += row[p] * row[q];
+      }
+    }
+  }
+  z.clear ();
+
+  vector<double> values;
+  vector<double> vectors;
+  eigenSymmetric (bbt, l, values, vectors);
+
+  //  Scores = Q U S, for the first K components
+  EXPRMATRIX scores;
+  scores.allocate (m, k);
+  double explained = 0.0;
+  for (c = 0; c < k; c++) {
+    double sigma = sqrt (max (values[c], 0.0));
+    explained += max (values[c], 0.0);
+    for (i = 0; i < m; i++) {
+      double sum = 0.0;
+      for (unsigned int p = 0; p < l; p++) {
+        sum += y[static_cast<size_t> (i) * l + p] * vectors[p * l + c];
+      }
+      scores.putExpr (i, c, sum * sigma);
+      scores.putNull (i, c, false);
+    }
+  }
+
+  for (i = 0; i < m; i++) {
+    scores.setName (i, data.getName (i));
+    scores.setColour (i, data.getColour (i));
+    scores.setShape (i, data.getShape (i));
+  }
+  scores.profileNulls ();
+  scores.calculateNorms ();
+
+  data.swap (scores);
+  setN (k);
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tPrincipal components:" << n << " to " << k << endl;
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tExplained variance:" << setprecision (4) << ((total == 0) ? 0.0 : 100 * explained / total) << "%" << setprecision (6) << endl;
+  }
+
+  return;
+}
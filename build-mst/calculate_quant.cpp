@@ -0,0 +1,383 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_quant.cpp
+    Additional member functions for BUILDMST class definition
+      Screening distances with quantized rows for --quantize
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+#include <algorithm>  //  max, min, swap
+
+#include <cstdint>  //  int8_t, int16_t, int64_t, uint64_t
+#include <cmath>  //  sqrt, fabs, lrint
+
+using namespace std;
+
+#include "BuildMSTConfig.hpp"
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+/*!
+     With --quantize, each row without NULLs is scaled so that its largest
+     expression level (in magnitude) becomes 127 (or 32767) and rounded to
+     an 8-bit (or 16-bit) integer.  The dot products between quantized
+     rows are calculated exactly with integer arithmetic by dotQuant8 ()
+     or dotQuant16 (), which read 8 (or 4) times fewer bytes per column
+     than the double-precision kernels.
+
+     The rounding error of each row, e, is known, so the distances
+     calculated from the quantized rows are turned into lower bounds on
+     the exact ones:
+
+       - Euclidean distance:  ||x - y|| >= ||x' - y'|| - ||e(x)|| - ||e(y)||
+       - Pearson, cosine and uncentered:  x.y <= x'.y' + ||x'|| ||e(y)|| +
+         ||e(x)|| ||y'|| + ||e(x)|| ||e(y)||, divided by the exact norms
+
+     where x' and y' are the quantized rows, scaled back.  The rows are
+     centered first for the Pearson correlation.  Single, average and
+     complete linkage of lower bounds are themselves lower bounds, so the
+     smallest linkage in the priority queue is never larger than the exact
+     one.  When a merge reaches the top of the queue, refineLinkage ()
+     recalculates the screened distances between its two clusters exactly
+     and, if any of them changed, the merge is put back into the queue
+     with its exact linkage.  So the merges are the same as without
+     --quantize (apart from ties and rounding); but the MSTs and scores
+     printed before each merge use the lower bounds of the pairs which
+     were never recalculated.
+
+     Rows with NULLs and sparse rows (see prepareSparse ()) are not
+     quantized and their distances are calculated exactly as usual.
+*/
+
+
+//!  Quantize the rows without NULLs
+/*!
+     \return Whether or not any rows were quantized
+*/
+bool BUILDMST::prepareQuantized () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  double levels = static_cast<double> ((1 << (getQuantize () - 1)) - 1);
+  unsigned int total = 0;
+  int i = 0;
+  unsigned int j = 0;
+
+  quant_rows.clear ();
+  quant8.clear ();
+  quant16.clear ();
+  quant_scales.clear ();
+  quant_squares.clear ();
+  quant_errors.clear ();
+  quant_norms.clear ();
+  quant_exact.clear ();
+  quant_refined = 0;
+  if ((getQuantize () == 0) || (n == 0)) {
+    return false;
+  }
+
+  quant_rows.assign (m, false);
+  for (i = 0; i < static_cast<int> (m); i++) {
+    if ((data.getProfile (i) == NULLS_NONE) && (sparse_rows.empty () || !sparse_rows[i])) {
+      quant_rows[i] = true;
+      total++;
+    }
+  }
+  if (total == 0) {
+    quant_rows.clear ();
+    return false;
+  }
+
+  //  Rows are padded with zeroes to a multiple of QUANT_BLOCK_COLUMNS
+  quant_stride = ((n + QUANT_BLOCK_COLUMNS - 1) / QUANT_BLOCK_COLUMNS) * QUANT_BLOCK_COLUMNS;
+  if (getQuantize () == 8) {
+    quant8.assign (static_cast<size_t> (m) * quant_stride, 0);
+  }
+  else {
+    quant16.assign (static_cast<size_t> (m) * quant_stride, 0);
+  }
+  quant_scales.assign (m, 0.0);
+  quant_squares.assign (m, 0.0);
+  quant_errors.assign (m, 0.0);
+  quant_norms.assign (m, 0.0);
+  //  Only the first MPI process merges clusters
+  if (getRank () == 0) {
+    quant_exact.assign (static_cast<size_t> (m) * (m - 1) / 2, false);
+  }
+
+  //  Each thread quantizes whole rows, so no two threads write to the same row
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (getThreads ()) private (j)
+#endif
+  for (i = 0; i < static_cast<int> (m); i++) {
+    if (!quant_rows[i]) {
+      continue;
+    }
+    EXPRROW row = data.getRow (i);
+    size_t offset = static_cast<size_t> (i) * quant_stride;
+    double mean = 0.0;
+    double largest = 0.0;
+    if (getDistance () == DIST_PEAR) {
+      for (j = 0; j < n; j++) {
+        mean += row.getExpr (j);
+      }
+      mean = mean / n;
+    }
+    for (j = 0; j < n; j++) {
+      largest = max (largest, fabs (row.getExpr (j) - mean));
+    }
+
+    //  A row of zeroes (or without variance) has a scale of 0 and no rounding error
+    double scale = largest / levels;
+    double squares = 0.0;
+    double errors = 0.0;
+    double norm = 0.0;
+    for (j = 0; j < n; j++) {
+      double expr = row.getExpr (j) - mean;
+      long level = (scale == 0) ? 0 : lrint (expr / scale);
+      level = max (-static_cast<long> (levels), min (static_cast<long> (levels), level));
+      if (getQuantize () == 8) {
+        quant8[offset + j] = static_cast<int8_t> (level);
+      }
+      else {
+        quant16[offset + j] = static_cast<int16_t> (level);
+      }
+      double error = expr - scale * level;
+      squares += static_cast<double> (level) * level;
+      errors += error * error;
+      norm += expr * expr;
+    }
+    quant_scales[i] = scale;
+    quant_squares[i] = squares;
+    quant_errors[i] = sqrt (errors);
+    quant_norms[i] = sqrt (norm);
+  }
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tRows quantized:" << total << endl;
+  }
+
+  return true;
+}
+
+
+//!  Calculate a lower bound on the distance between experiments i and j, which are both quantized
+/*!
+     \return The lower bound, which is never negative
+*/
+double BUILDMST::calculateQuantized (unsigned int i, unsigned int j) const {
+  size_t x = static_cast<size_t> (i) * quant_stride;
+  size_t y = static_cast<size_t> (j) * quant_stride;
+  double dot = 0.0;
+  double score = 0.0;
+
+  if (getQuantize () == 8) {
+    dot = static_cast<double> (dotQuant8 (&quant8[x], &quant8[y], quant_stride));
+  }
+  else {
+    dot = static_cast<double> (dotQuant16 (&quant16[x], &quant16[y], quant_stride));
+  }
+  dot = dot * quant_scales[i] * quant_scales[j];
+
+  double norm1 = quant_scales[i] * sqrt (quant_squares[i]);
+  double norm2 = quant_scales[j] * sqrt (quant_squares[j]);
+  if (getDistance () == DIST_EUC) {
+    //  Rounding can make the squared distance slightly negative
+    score = sqrt (max (0.0, norm1 * norm1 + norm2 * norm2 - 2 * dot));
+    score = score - quant_errors[i] - quant_errors[j];
+  }
+  else if (quant_norms[i] * quant_norms[j] == 0) {
+    //  Maximum possible distance
+    score = 2.0;
+  }
+  else {
+    double bound = dot + norm1 * quant_errors[j] + quant_errors[i] * norm2 + quant_errors[i] * quant_errors[j];
+    score = 1 - bound / (quant_norms[i] * quant_norms[j]);
+  }
+
+  return max (0.0, score);
+}
+
+
+//!  Recalculate the distance between experiments i and j exactly, if it was screened
+/*!
+     \return Whether or not the distance was recalculated
+
+     T is the precision of the distance matrix, which has been detached
+     from its file (if any) by initializeDistances (), so a cache entry
+     only ever holds the lower bounds.
+*/
+template <typename T>
+bool BUILDMST::refineDistance (unsigned int i, unsigned int j) {
+  unsigned int m = getM ();
+
+  if (i > j) {
+    swap (i, j);
+  }
+  if (!(quant_rows[i] && quant_rows[j])) {
+    return false;
+  }
+  //  Position of the pair in the upper triangle, row by row
+  size_t pair = static_cast<size_t> (i) * m - static_cast<size_t> (i) * (i + 1) / 2 + (j - i - 1);
+  if (quant_exact[pair]) {
+    return false;
+  }
+
+  getDistMatrix<T> ().set (i, j, calculateDistance<NULLS_NONE> (i, j));
+  quant_exact[pair] = true;
+  quant_refined++;
+
+  return true;
+}
+
+
+//!  Recalculate the screened distances between two clusters that are needed for their exact linkage
+/*!
+     \param left The first cluster of the merge at the top of the priority queue
+     \param right The second cluster
+     \param score Set to the exact linkage between the clusters, if any
+            distance was recalculated
+     \return Whether or not any distance was recalculated
+
+     T is the precision of the distance matrix.  For single linkage, only
+     the closest pair has to be exact:  the closest pair is recalculated
+     until it is one whose distance is already exact, since every other
+     pair is at least as far apart as its lower bound.  Average and
+     complete linkage need every pair.  Centroid linkage between merged
+     clusters does not use the distance matrix, so there is nothing to
+     recalculate.  As in queueDistances (), the linkage between two single
+     experiments is their distance.
+*/
+template <typename T>
+bool BUILDMST::refineLinkage (unsigned int left, unsigned int right, T &score) {
+  unsigned int m = getM ();
+  bool refined = false;
+  unsigned int a = 0;
+  unsigned int b = 0;
+
+  if (quant_rows.empty ()) {
+    return false;
+  }
+  if ((getLinkage () == LINK_CENTROID) && ((left >= m) || (right >= m))) {
+    return false;
+  }
+
+  const DISTMATRIX<T> &dist_matrix = getDistMatrix<T> ();
+  vector<unsigned int> items1 = clusters[left].getItems ();
+  vector<unsigned int> items2 = clusters[right].getItems ();
+  if (getLinkage () == LINK_SINGLE) {
+    bool closest_exact = false;
+    while (!closest_exact) {
+      unsigned int closest1 = items1[0];
+      unsigned int closest2 = items2[0];
+      for (a = 0; a < items1.size (); a++) {
+        for (b = 0; b < items2.size (); b++) {
+          if (dist_matrix.get (items1[a], items2[b]) < dist_matrix.get (closest1, closest2)) {
+            closest1 = items1[a];
+            closest2 = items2[b];
+          }
+        }
+      }
+      if (refineDistance<T> (closest1, closest2)) {
+        refined = true;
+      }
+      else {
+        closest_exact = true;
+      }
+    }
+  }
+  else {
+    for (a = 0; a < items1.size (); a++) {
+      for (b = 0; b < items2.size (); b++) {
+        if (refineDistance<T> (items1[a], items2[b])) {
+          refined = true;
+        }
+      }
+    }
+  }
+
+  if (refined) {
+    if ((left < m) && (right < m)) {
+      score = dist_matrix.get (left, right);
+    }
+    else {
+      score = calculateLink<T> (left, right);
+    }
+  }
+
+  return refined;
+}
+
+//  Instantiate the refinement for each precision of the distance matrix
+template bool BUILDMST::refineDistance<float> (unsigned int i, unsigned int j);
+template bool BUILDMST::refineDistance<double> (unsigned int i, unsigned int j);
+template bool BUILDMST::refineLinkage<float> (unsigned int left, unsigned int right, float &score);
+template bool BUILDMST::refineLinkage<double> (unsigned int left, unsigned int right, double &score);
+
+
+//!  Print how many of the screened distances had to be recalculated exactly
+void BUILDMST::reportQuantized () const {
+  if (quant_exact.empty ()) {
+    return;
+  }
+
+  cerr << left << setw (VERBOSE_WIDTH) << "==\tDistances screened:" << quant_exact.size () << endl;
+  cerr << left << setw (VERBOSE_WIDTH) << "==\tDistances recalculated:" << quant_refined << endl;
+
+  return;
+}
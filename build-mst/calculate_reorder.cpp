@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_reorder.cpp
+    Additional member functions for BUILDMST class definition
+      Renumbering the experiments for --reorder
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+#include <algorithm>  //  stable_sort
+
+#include <cstdint>  //  uint64_t
+#include <cmath>  //  sqrt
+
+using namespace std;
+
+#include "BuildMSTConfig.hpp"
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+/*!
+     The linkage and scoring functions look up the distances between the
+     members of clusters, which are scattered across the distance matrix
+     when the experiments are numbered in file order.  With --reorder,
+     the experiments are renumbered before any distances are calculated
+     so that similar experiments get nearby numbers; the members of a
+     cluster then tend to be close together in the matrix.
+
+     The order is found by recursive bisection:  the rows are sorted by
+     their projection on the principal direction of the rows (found by
+     power iteration) and split in half, and each half is ordered the same
+     way, until at most REORDER_LEAF_ROWS rows are left.  This takes time
+     in proportion to M N log M, much less than the distances themselves.
+     For the correlations, the rows are centred (except for the cosine
+     and uncentered distances) and scaled to unit norm first; NULLs are
+     replaced by the mean of their row.
+
+     The experiments are mapped back to their numbers in the data file by
+     getOriginalID () when the results are printed.
+*/
+
+
+//!  The value of a row used for ordering, after filling in NULLs, centring and scaling
+static inline double orderValue (const EXPRROW &row, unsigned int j, double fill, double centre, double scale) {
+  return (((row.isNull (j) ? fill : row.getExpr (j)) - centre) * scale);
+}
+
+
+//!  Order some of the rows by recursive bisection
+/*!
+     \param data The expression levels
+     \param fills The value of the NULLs of each row
+     \param centres The value subtracted from each row
+     \param scales The value each row is multiplied by
+     \param rows The rows to order, which are reordered in place
+     \param count The number of rows
+     \param threads The number of threads
+*/
+static void bisectRows (const EXPRMATRIX &data, const vector<double> &fills, const vector<double> &centres, const vector<double> &scales, unsigned int *rows, unsigned int count, unsigned int threads) {
+  unsigned int n = data.getN ();
+  unsigned int iter = 0;
+  unsigned int j = 0;
+  int k = 0;
+
+  if (count <= REORDER_LEAF_ROWS) {
+    return;
+  }
+
+  //  Mean of the rows, which is subtracted from each of them
+  vector<double> mean (n, 0.0);
+  for (k = 0; k < static_cast<int> (count); k++) {
+    EXPRROW row = data.getRow (rows[k]);
+    for (j = 0; j < n; j++) {
+      mean[j] += orderValue (row, j, fills[rows[k]], centres[rows[k]], scales[rows[k]]);
+    }
+  }
+  for (j = 0; j < n; j++) {
+    mean[j] = mean[j] / count;
+  }
+
+  //  Start the power iteration from the first row, for repeatability
+  vector<double> direction (n, 0.0);
+  EXPRROW first = data.getRow (rows[0]);
+  for (j = 0; j < n; j++) {
+    direction[j] = orderValue (first, j, fills[rows[0]], centres[rows[0]], scales[rows[0]]) - mean[j];
+  }
+
+  vector<pair<double, unsigned int> > keys (count);
+  for (iter = 0; iter <= REORDER_POWER_ITERATIONS; iter++) {
+    double norm = 0.0;
+    for (j = 0; j < n; j++) {
+      norm += direction[j] * direction[j];
+    }
+    if (norm == 0) {
+      break;
+    }
+    norm = sqrt (norm);
+    for (j = 0; j < n; j++) {
+      direction[j] = direction[j] / norm;
+    }
+
+    //  Project each row onto the direction
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (threads) private (j)
+#endif
+    for (k = 0; k < static_cast<int> (count); k++) {
+      EXPRROW row = data.getRow (rows[k]);
+      double key = 0.0;
+      for (j = 0; j < n; j++) {
+        key += (orderValue (row, j, fills[rows[k]], centres[rows[k]], scales[rows[k]]) - mean[j]) * direction[j];
+      }
+      keys[k] = make_pair (key, rows[k]);
+    }
+    if (iter == REORDER_POWER_ITERATIONS) {
+      break;
+    }
+
+    //  The next direction is the sum of the rows weighted by their projections
+    direction.assign (n, 0.0);
+    for (k = 0; k < static_cast<int> (count); k++) {
+      EXPRROW row = data.getRow (rows[k]);
+      for (j = 0; j < n; j++) {
+        direction[j] += keys[k].first * (orderValue (row, j, fills[rows[k]], centres[rows[k]], scales[rows[k]]) - mean[j]);
+      }
+    }
+  }
+
+  //  Without a direction (i.e., identical rows), the rows are left as they are
+  if (iter <= REORDER_POWER_ITERATIONS) {
+    stable_sort (keys.begin (), keys.end ());
+    for (k = 0; k < static_cast<int> (count); k++) {
+      rows[k] = keys[k].second;
+    }
+  }
+
+  bisectRows (data, fills, centres, scales, rows, count / 2, threads);
+  bisectRows (data, fills, centres, scales, rows + count / 2, count - count / 2, threads);
+
+  return;
+}
+
+
+//!  Renumber the experiments so that similar ones are close together
+void BUILDMST::reorderData () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  unsigned int i = 0;
+  unsigned int j = 0;
+  bool centred = (getDistance () != DIST_EUC) && (getDistance () != DIST_MAN) &&
+    (getDistance () != DIST_COSINE) && (getDistance () != DIST_UNCENTERED);
+  bool scaled = (getDistance () != DIST_EUC) && (getDistance () != DIST_MAN);
+  vector<double> fills (m, 0.0);
+  vector<double> centres (m, 0.0);
+  vector<double> scales (m, 1.0);
+
+  original_ids.resize (m);
+  for (i = 0; i < m; i++) {
+    original_ids[i] = i;
+  }
+  if (n == 0) {
+    return;
+  }
+
+  for (i = 0; i < m; i++) {
+    EXPRROW row = data.getRow (i);
+    unsigned int count = 0;
+    double sum = 0.0;
+    for (j = 0; j < n; j++) {
+      if (!row.isNull (j)) {
+        sum += row.getExpr (j);
+        count++;
+      }
+    }
+    if (count != 0) {
+      fills[i] = sum / count;
+    }
+    if (centred) {
+      centres[i] = fills[i];
+    }
+    if (scaled) {
+      double norm = 0.0;
+      for (j = 0; j < n; j++) {
+        double value = orderValue (row, j, fills[i], centres[i], 1.0);
+        norm += value * value;
+      }
+      scales[i] = (norm == 0) ? 0.0 : 1 / sqrt (norm);
+    }
+  }
+
+  bisectRows (data, fills, centres, scales, &original_ids[0], m, getThreads ());
+
+  data.permuteRows (original_ids);
+  //  The original rows kept for --sketch-check are renumbered too
+  if (exact.getM () == m) {
+    exact.permuteRows (original_ids);
+  }
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tExperiments reordered:" << m << endl;
+  }
+
+  return;
+}
+
+
+//!  Get the number of an experiment in the data file
+/*!
+     \param id The ID of a cluster
+     \return The original number, if the cluster is a single experiment
+             renumbered by reorderData (); the ID itself otherwise
+*/
+unsigned int BUILDMST::getOriginalID (unsigned int id) const {
+  if (id < original_ids.size ()) {
+    return original_ids[id];
+  }
+
+  return id;
+}
@@ -0,0 +1,252 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_sketch.cpp
+    Additional member functions for BUILDMST class definition
+      Random projection of the rows for --sketch-dim
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+
+#include <algorithm>  //  min, max
+
+#include <cstdint>  //  uint32_t, uint64_t
+#include <cmath>  //  sqrt, fabs
+
+using namespace std;
+
+#include "BuildMSTConfig.hpp"
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+/*!
+     With --sketch-dim K, each row is multiplied by a sparse N by K matrix
+     of random signs once it has been read in, and every distance is then
+     calculated on the K-dimensional sketches instead.  By the
+     Johnson-Lindenstrauss lemma, Euclidean distances (and the angles used
+     by the cosine and uncentered distances) are preserved to within a
+     factor that depends on K but not on N.
+
+     The matrix is never stored.  Each column has SKETCH_NONZEROS
+     non-zero entries of +1 or -1, one in each of SKETCH_NONZEROS equal
+     blocks of the K dimensions, whose positions and signs come from a
+     hash of the seed and the column.  So, projecting a row costs
+     SKETCH_NONZEROS additions per column, and the same seed always gives
+     the same sketches.
+*/
+
+
+//!  Mix the bits of a 64-bit integer (the finaliser of splitmix64)
+static uint64_t mixBits (uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+  return (x ^ (x >> 31));
+}
+
+
+//!  Project every row into --sketch-dim dimensions
+/*!
+     The original rows are kept in exact with --sketch-check and released
+     otherwise.  NULLs are treated as zeroes, so the sketches have no NULLs.
+     Nothing is done if there are no more columns than dimensions.
+*/
+void BUILDMST::sketchData () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  unsigned int k = getSketchDim ();
+  unsigned int nonzeros = min (k, static_cast<unsigned int> (SKETCH_NONZEROS));
+  unsigned int j = 0;
+  unsigned int b = 0;
+  int i = 0;
+
+  if (n <= k) {
+    if (getVerbose ()) {
+      cerr << "==\tWarning:  --sketch-dim is not smaller than the number of columns; the rows are not projected." << endl;
+    }
+    setSketchDim (0);
+    return;
+  }
+
+  //  Position (and sign, in the top bit) of the non-zero entries of each column
+  vector<uint32_t> entries (static_cast<size_t> (n) * nonzeros);
+  for (j = 0; j < n; j++) {
+    for (b = 0; b < nonzeros; b++) {
+      uint64_t hash = mixBits ((static_cast<uint64_t> (getSketchSeed ()) << 32) ^ (static_cast<uint64_t> (j) * nonzeros + b));
+      unsigned int lo = static_cast<unsigned int> ((static_cast<uint64_t> (k) * b) / nonzeros);
+      unsigned int hi = static_cast<unsigned int> ((static_cast<uint64_t> (k) * (b + 1)) / nonzeros);
+      entries[static_cast<size_t> (j) * nonzeros + b] = (lo + static_cast<unsigned int> ((hash & 0xFFFFFFFF) % (hi - lo))) | static_cast<uint32_t> ((hash >> 32) & 0x80000000);
+    }
+  }
+
+  EXPRMATRIX sketch;
+  sketch.allocate (m, k);
+  double scale = 1 / sqrt (static_cast<double> (nonzeros));
+
+  //  Each thread projects whole rows, so no two threads write to the same row
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (getThreads ())
+#endif
+  for (i = 0; i < static_cast<int> (m); i++) {
+    EXPRROW row = data.getRow (i);
+    vector<double> sums (k, 0.0);
+    for (unsigned int c = 0; c < n; c++) {
+      if (row.isNull (c)) {
+        continue;
+      }
+      double value = row.getExpr (c);
+      const uint32_t *entry = &entries[static_cast<size_t> (c) * nonzeros];
+      for (unsigned int e = 0; e < nonzeros; e++) {
+        if (entry[e] & 0x80000000) {
+          sums[entry[e] & 0x7FFFFFFF] -= value;
+        }
+        else {
+          sums[entry[e]] += value;
+        }
+      }
+    }
+    for (unsigned int c = 0; c < k; c++) {
+      sketch.putExpr (i, c, sums[c] * scale);
+      sketch.putNull (i, c, false);
+    }
+  }
+
+  for (i = 0; i < static_cast<int> (m); i++) {
+    sketch.setName (i, data.getName (i));
+    sketch.setColour (i, data.getColour (i));
+    sketch.setShape (i, data.getShape (i));
+  }
+  sketch.profileNulls ();
+  sketch.calculateNorms ();
+
+  data.swap (sketch);
+  if (getSketchCheck ()) {
+    exact.swap (sketch);
+  }
+  setN (k);
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tSketch projection:" << n << " to " << k << " (seed " << getSketchSeed () << ")" << endl;
+  }
+
+  return;
+}
+
+
+//!  Compare the distance of an accepted merge against the exact one
+/*!
+     \param left The first cluster of the merge
+     \param right The second cluster of the merge
+     \param score The distance between them, from the sketches
+
+     Only merges of two single experiments are compared, since the
+     distance between larger clusters depends on the linkage and on many
+     exact distances.  The relative distortion is collected for
+     reportSketch ().
+*/
+void BUILDMST::checkSketch (unsigned int left, unsigned int right, double score) {
+  double distance = 0.0;
+
+  if ((getSketchDim () == 0) || (!getSketchCheck ()) || (left >= getM ()) || (right >= getM ())) {
+    return;
+  }
+
+  EXPRROW x = exact.getRow (left);
+  EXPRROW y = exact.getRow (right);
+  switch (getDistance ()) {
+    case DIST_COSINE :
+      distance = x.simCosine (y, exact.getNorm (left), exact.getNorm (right));
+      break;
+    case DIST_UNCENTERED :
+      distance = x.simUncentered (y, exact.getNorm (left), exact.getNorm (right));
+      break;
+    default :
+      distance = x.simEuc (y);
+      break;
+  }
+
+  if (distance > 0) {
+    double distortion = fabs (score - distance) / distance;
+    sketch_sum += distortion;
+    sketch_max = max (sketch_max, distortion);
+    sketch_checked++;
+  }
+
+  if (getDebug ()) {
+    cerr << "===\t\tExact distance:  " << distance << "\tSketch distance:  " << score << endl;
+  }
+
+  return;
+}
+
+
+//!  Print the distortion of the merges compared by checkSketch ()
+void BUILDMST::reportSketch () const {
+  if ((getSketchDim () == 0) || (!getSketchCheck ())) {
+    return;
+  }
+
+  cerr << left << setw (VERBOSE_WIDTH) << "==\tSketch merges compared:" << sketch_checked << endl;
+  if (sketch_checked != 0) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tSketch distortion (mean):" << sketch_sum / sketch_checked << endl;
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tSketch distortion (max):" << sketch_max << endl;
+  }
+
+  return;
+}
@@ -0,0 +1,259 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_sparse.cpp
+    Additional member functions for BUILDMST class definition
+      Compressed sparse rows for zero-heavy count matrices
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+
+#include <cstdint>  //  uint64_t
+#include <cmath>  //  sqrt
+
+using namespace std;
+
+#include "BuildMSTConfig.hpp"
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect_sparse.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+/*!
+     Rows without NULLs whose fraction of non-zero expression levels is at
+     most SPARSE_MAX_DENSITY are also stored in compressed sparse row (CSR)
+     form:  the columns and values of the non-zeroes of row i are found
+     from sparse_starts[i] up to sparse_starts[i + 1] of sparse_columns and
+     sparse_values.  Pairs where both rows are sparse are then calculated
+     by calculateSparse () in time proportional to their non-zeroes.
+     Pairs where either row is dense (or has NULLs) are calculated as
+     usual.
+
+     The Pearson correlation only needs the dot product from the pair,
+     since the sum and the sum of squares of each row (sparse_sums and
+     sparse_squares) are calculated here once.  The cosine and uncentered
+     distances use the norms of the rows (see EXPRMATRIX::getNorm ()).
+
+     Since zeroes are skipped and the sums are added in a different order,
+     results can differ from calculateDistance () in the last few bits.
+*/
+
+
+//!  Store the rows with few non-zeroes in compressed sparse form
+/*!
+     \return Whether or not any rows are sparse
+
+     Only the Euclidean, Manhattan, Pearson, cosine and uncentered
+     distances are supported; nothing is done for the others.
+*/
+bool BUILDMST::prepareSparse () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  unsigned int limit = static_cast<unsigned int> (SPARSE_MAX_DENSITY * n);
+  unsigned int total = 0;
+  size_t nonzeroes = 0;
+  vector<unsigned int> counts (m, 0);
+  int i = 0;
+  unsigned int j = 0;
+
+  sparse_rows.clear ();
+  sparse_starts.clear ();
+  sparse_columns.clear ();
+  sparse_values.clear ();
+  sparse_sums.clear ();
+  sparse_squares.clear ();
+
+  switch (getDistance ()) {
+    case DIST_EUC :
+    case DIST_MAN :
+    case DIST_PEAR :
+    case DIST_COSINE :
+    case DIST_UNCENTERED :
+      break;
+    default :
+      return false;
+  }
+  if (n == 0) {
+    return false;
+  }
+
+  //  Count the non-zeroes of each row without NULLs; rows with NULLs
+  //    are given more than the limit
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (getThreads ()) private (j)
+#endif
+  for (i = 0; i < static_cast<int> (m); i++) {
+    if (data.getProfile (i) != NULLS_NONE) {
+      counts[i] = n + 1;
+      continue;
+    }
+    EXPRROW row = data.getRow (i);
+    for (j = 0; j < n; j++) {
+      if (row.getExpr (j) != 0) {
+        counts[i]++;
+      }
+    }
+  }
+
+  //  Lay the sparse rows out one after another
+  sparse_rows.assign (m, false);
+  sparse_starts.assign (static_cast<size_t> (m) + 1, 0);
+  for (i = 0; i < static_cast<int> (m); i++) {
+    if (counts[i] <= limit) {
+      sparse_rows[i] = true;
+      nonzeroes += counts[i];
+      total++;
+    }
+    sparse_starts[i + 1] = nonzeroes;
+  }
+  if (total == 0) {
+    sparse_rows.clear ();
+    sparse_starts.clear ();
+    return false;
+  }
+
+  sparse_columns.assign (nonzeroes, 0);
+  sparse_values.assign (nonzeroes, 0.0);
+  sparse_sums.assign (m, 0.0);
+  sparse_squares.assign (m, 0.0);
+
+  //  Each thread fills in whole rows, so no two threads write to the same row
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (getThreads ()) private (j)
+#endif
+  for (i = 0; i < static_cast<int> (m); i++) {
+    if (!sparse_rows[i]) {
+      continue;
+    }
+    EXPRROW row = data.getRow (i);
+    size_t k = sparse_starts[i];
+    for (j = 0; j < n; j++) {
+      double expr = row.getExpr (j);
+      if (expr != 0) {
+        sparse_columns[k] = j;
+        sparse_values[k] = expr;
+        sparse_sums[i] += expr;
+        sparse_squares[i] += expr * expr;
+        k++;
+      }
+    }
+  }
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tSparse rows:" << total << endl;
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tDensity of sparse rows:" << static_cast<double> (nonzeroes) / (static_cast<double> (total) * n) << endl;
+  }
+
+  return true;
+}
+
+
+//!  Calculate the distance between experiments i and j, which are both sparse
+/*!
+     \return The distance, as calculated by calculateDistance ()
+*/
+double BUILDMST::calculateSparse (unsigned int i, unsigned int j) const {
+  double score = 0.0;
+  const unsigned int *x_cols = &sparse_columns[0] + sparse_starts[i];
+  const unsigned int *y_cols = &sparse_columns[0] + sparse_starts[j];
+  const double *x_vals = &sparse_values[0] + sparse_starts[i];
+  const double *y_vals = &sparse_values[0] + sparse_starts[j];
+  unsigned int x_count = static_cast<unsigned int> (sparse_starts[i + 1] - sparse_starts[i]);
+  unsigned int y_count = static_cast<unsigned int> (sparse_starts[j + 1] - sparse_starts[j]);
+
+  switch (getDistance ()) {
+    case DIST_EUC :
+      score = sqrt (sparseSqDiff (x_cols, x_vals, x_count, y_cols, y_vals, y_count));
+      break;
+    case DIST_MAN :
+      score = sparseAbsDiff (x_cols, x_vals, x_count, y_cols, y_vals, y_count);
+      break;
+    case DIST_PEAR :
+      {
+        double n = static_cast<double> (getN ());
+        double sumxy = sparseDot (x_cols, x_vals, x_count, y_cols, y_vals, y_count);
+        double num = (n * sumxy) - (sparse_sums[i] * sparse_sums[j]);
+        double den1 = (n * sparse_squares[i]) - (sparse_sums[i] * sparse_sums[i]);
+        double den2 = (n * sparse_squares[j]) - (sparse_sums[j] * sparse_sums[j]);
+        if (den1 * den2 == 0) {
+          //  Maximum possible distance
+          score = 2.0;
+        }
+        else {
+          score = 1 - num / (sqrt (den1 * den2));
+        }
+      }
+      break;
+    case DIST_COSINE :
+    case DIST_UNCENTERED :
+      {
+        double den = data.getNorm (i) * data.getNorm (j);
+        if (den == 0) {
+          //  Maximum possible distance
+          score = 2.0;
+        }
+        else {
+          score = 1 - sparseDot (x_cols, x_vals, x_count, y_cols, y_vals, y_count) / den;
+        }
+      }
+      break;
+    default :
+      break;
+  }
+
+  return score;
+}
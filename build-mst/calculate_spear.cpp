@@ -0,0 +1,414 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_spear.cpp
+    Additional member functions for BUILDMST class definition
+      Functions for sharing Spearman ranks between pairs
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+#include <map>
+#include <unordered_map>
+#include <algorithm>  //  max, swap, binary_search
+
+#include <cstdint>  //  uint64_t
+
+using namespace std;
+
+#include "BuildMSTConfig.hpp"
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+
+//!  Rank the columns of a row which are not flagged in a NULL mask
+/*!
+     \param row The row of expression levels
+     \param mask A NULL bitmap (set = column is left out)
+     \return The ranks of the remaining columns, in their original order,
+             allocated with new
+
+     This gives the same ranks as simSpear () does for a row when the mask
+     is the combination of the NULL bitmaps of the two rows in the pair.
+*/
+static VECT *rankMasked (EXPRROW row, const vector<uint64_t> &mask) {
+  unsigned int n2 = 0;
+  vector<SPEARMAN> spears;
+
+  for (unsigned int j = 0; j < row.getN (); j++) {
+    if (((mask[j / NULL_WORD_BITS] >> (j % NULL_WORD_BITS)) & 1) == 0) {
+      spears.push_back (SPEARMAN (row.getExpr (j), n2, 0));
+      n2++;
+    }
+  }
+  rankSpearman (spears);
+
+  return (new VECT (spears));
+}
+
+
+//!  Calculate the Spearman ranks of the rows without NULLs
+/*!
+     If neither row in a pair has NULLs, then the ranks of each row do not
+     depend on the other row.  So, they are calculated once per row here
+     instead of once per pair, and the Pearson correlation is applied to
+     them directly.  The result is the same as simSpear ().  Pairs where
+     either row has NULLs are ranked by simSpear () as before, since the
+     ranks only cover the columns where both rows are non-null.
+*/
+void BUILDMST::prepareRanks () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  unsigned int total = 0;
+  int i = 0;
+
+  ranked.assign (m, false);
+  ranks.allocate (m, n);
+
+  for (i = 0; i < static_cast<int> (m); i++) {
+    EXPRROW row = data.getRow (i);
+    if (countNonNull (row.getNulls (), row.getNulls (), row.getWords ()) == n) {
+      ranked[i] = true;
+      total++;
+    }
+  }
+
+  //  Each thread ranks whole rows, so no two threads write to the same row
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (getThreads ())
+#endif
+  for (i = 0; i < static_cast<int> (m); i++) {
+    if (!ranked[i]) {
+      continue;
+    }
+
+    EXPRROW row = data.getRow (i);
+    vector<SPEARMAN> spears;
+    for (unsigned int j = 0; j < n; j++) {
+      spears.push_back (SPEARMAN (row.getExpr (j), j, 0));
+    }
+    rankSpearman (spears);
+
+    for (unsigned int j = 0; j < n; j++) {
+      ranks.putExpr (i, j, spears[j].getRank ());
+      ranks.putNull (i, j, false);
+    }
+  }
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tRows ranked in advance:" << total << endl;
+  }
+
+  return;
+}
+
+
+//!  Calculate the 64-bit FNV-1a hash of the combined NULL mask of two NULL patterns, a word at a time
+static uint64_t hashMask (const vector<uint64_t> &x, const vector<uint64_t> &y) {
+  uint64_t hash = HASH_FNV_OFFSET;
+
+  for (size_t k = 0; k < x.size (); k++) {
+    hash = (hash ^ (x[k] | y[k])) * HASH_FNV_PRIME;
+  }
+
+  return hash;
+}
+
+
+//!  Group the Spearman pairs with NULLs by their combined NULL mask
+/*!
+     The ranks for a pair where either row has NULLs only cover the columns
+     that are non-null in both rows, so they depend on the combined NULL
+     mask of the pair.  But data sets usually have only a few distinct NULL
+     patterns (for example, probes missing from a whole batch), so many
+     pairs share the same mask.
+
+     The rows are grouped by their NULL pattern.  The pairs of patterns
+     are first counted by a 64-bit hash of their combined mask, without
+     keeping the masks themselves; only the masks used by more than one
+     pair of rows are then kept, as groups for calculateSpearmanGroups ().
+     The other pairs are left to simSpear () in the tiles, as are all of
+     them if there are more than SPEARMAN_MAX_GROUPS shared masks.
+*/
+void BUILDMST::prepareSpearmanGroups () {
+  unsigned int m = getM ();
+  unsigned int n = getN ();
+  unsigned int words = (n + NULL_WORD_BITS - 1) / NULL_WORD_BITS;
+  unsigned int i = 0;
+  unsigned int p = 0;
+  unsigned int q = 0;
+  unsigned int k = 0;
+  size_t total = 0;
+  size_t grouped = 0;
+  bool overflow = false;
+
+  spear_patterns.assign (m, 0);
+  spear_pattern_rows.clear ();
+  spear_masks.clear ();
+  spear_groups.clear ();
+  spear_grouped.clear ();
+
+  //  Group the rows by their NULL pattern
+  map<vector<uint64_t>, unsigned int> pattern_ids;
+  vector<vector<uint64_t> > patterns;
+  for (i = 0; i < m; i++) {
+    EXPRROW row = data.getRow (i);
+    vector<uint64_t> key (row.getNulls (), row.getNulls () + words);
+    map<vector<uint64_t>, unsigned int>::iterator it = pattern_ids.find (key);
+    if (it == pattern_ids.end ()) {
+      it = pattern_ids.insert (make_pair (key, patterns.size ())).first;
+      patterns.push_back (key);
+      spear_pattern_rows.push_back (vector<unsigned int> ());
+    }
+    spear_patterns[i] = it -> second;
+    spear_pattern_rows[it -> second].push_back (i);
+  }
+  unsigned int num_patterns = patterns.size ();
+
+  //  Count the pairs of rows that use each combined mask, by its hash
+  unordered_map<uint64_t, size_t> counts;
+  for (p = 0; p < num_patterns; p++) {
+    for (q = p; q < num_patterns; q++) {
+      size_t pairs = spearmanPatternPairs (p, q);
+      if (pairs != 0) {
+        counts[hashMask (patterns[p], patterns[q])] += pairs;
+        total += pairs;
+      }
+    }
+  }
+
+  //  Keep the masks used by more than one pair; a hash collision only
+  //    means that a mask is kept for a single pair
+  map<vector<uint64_t>, unsigned int> mask_ids;
+  for (p = 0; (p < num_patterns) && (!overflow); p++) {
+    for (q = p; q < num_patterns; q++) {
+      size_t pairs = spearmanPatternPairs (p, q);
+      if ((pairs == 0) || (counts[hashMask (patterns[p], patterns[q])] < 2)) {
+        continue;
+      }
+
+      vector<uint64_t> key (words);
+      for (k = 0; k < words; k++) {
+        key[k] = patterns[p][k] | patterns[q][k];
+      }
+      map<vector<uint64_t>, unsigned int>::iterator it = mask_ids.find (key);
+      if (it == mask_ids.end ()) {
+        if (spear_masks.size () == SPEARMAN_MAX_GROUPS) {
+          overflow = true;
+          break;
+        }
+        it = mask_ids.insert (make_pair (key, spear_masks.size ())).first;
+        spear_masks.push_back (key);
+        spear_groups.push_back (vector<pair<unsigned int, unsigned int> > ());
+      }
+      spear_groups[it -> second].push_back (make_pair (p, q));
+      //  Added in increasing order, so spear_grouped stays sorted
+      spear_grouped.push_back (static_cast<uint64_t> (p) * num_patterns + q);
+      grouped += pairs;
+    }
+  }
+
+  //  Too many shared masks to keep; every pair is left to simSpear ()
+  if (overflow) {
+    spear_masks.clear ();
+    spear_groups.clear ();
+    spear_grouped.clear ();
+    grouped = 0;
+  }
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tSpearman pairs with NULLs:" << total << endl;
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tSpearman NULL masks shared:";
+    if (overflow) {
+      cerr << "None (more than " << SPEARMAN_MAX_GROUPS << ")" << endl;
+    }
+    else {
+      cerr << spear_masks.size () << " (" << grouped << " pairs)" << endl;
+    }
+  }
+
+  return;
+}
+
+
+//!  Count the pairs of rows with NULL patterns p and q that this process calculates by ranking
+/*!
+     \param p The first NULL pattern
+     \param q The second NULL pattern (p <= q)
+     \return The number of pairs, or 0 if both patterns are without NULLs
+             or the pairs were copied from the cache or are calculated by
+             another process
+*/
+size_t BUILDMST::spearmanPatternPairs (unsigned int p, unsigned int q) const {
+  const vector<unsigned int> &left = spear_pattern_rows[p];
+  const vector<unsigned int> &right = spear_pattern_rows[q];
+
+  //  Pairs of rows without NULLs use the ranks of prepareRanks ()
+  if (ranked[left[0]] && ranked[right[0]]) {
+    return 0;
+  }
+  //  Pairs among the rows before first_new were copied from the cache,
+  //    and those before column_begin are calculated by another process
+  if (max (left.back (), right.back ()) < max (first_new, column_begin)) {
+    return 0;
+  }
+  if (p == q) {
+    return (static_cast<size_t> (left.size ()) * (left.size () - 1) / 2);
+  }
+
+  return (static_cast<size_t> (left.size ()) * right.size ());
+}
+
+
+//!  Whether the Spearman correlation of experiments i and j is calculated by calculateSpearmanGroups ()
+bool BUILDMST::spearmanGrouped (unsigned int i, unsigned int j) const {
+  if (spear_grouped.empty ()) {
+    return false;
+  }
+  uint64_t p = spear_patterns[i];
+  uint64_t q = spear_patterns[j];
+  if (p > q) {
+    swap (p, q);
+  }
+
+  return (binary_search (spear_grouped.begin (), spear_grouped.end (), p * spear_pattern_rows.size () + q));
+}
+
+
+//!  Calculate the Spearman correlations of the pairs whose combined NULL mask is shared
+/*!
+     For each mask kept by prepareSpearmanGroups () in turn, every row
+     involved is ranked once under that mask and the ranks are reused for
+     all of its pairs; they are released before moving on to the next
+     mask.  The results are the same as calling simSpear () on every pair.
+*/
+void BUILDMST::calculateSpearmanGroups () {
+  unsigned int m = getM ();
+  unsigned int i = 0;
+  unsigned int p = 0;
+  unsigned int q = 0;
+  unsigned int g = 0;
+  unsigned int k = 0;
+
+  //  Position of each row in the ranks of the current group (-1 if absent)
+  vector<int> slot (m, -1);
+
+  for (g = 0; g < spear_groups.size (); g++) {
+    vector<unsigned int> members;
+    //  Each row of the first pattern of each pair of patterns, so that
+    //    groups of single rows are shared out between the threads too
+    vector<pair<unsigned int, unsigned int> > items;
+
+    for (k = 0; k < spear_groups[g].size (); k++) {
+      p = spear_groups[g][k].first;
+      q = spear_groups[g][k].second;
+      for (i = 0; i < spear_pattern_rows[p].size (); i++) {
+        if (slot[spear_pattern_rows[p][i]] == -1) {
+          slot[spear_pattern_rows[p][i]] = members.size ();
+          members.push_back (spear_pattern_rows[p][i]);
+        }
+        items.push_back (make_pair (k, i));
+      }
+      for (i = 0; i < spear_pattern_rows[q].size (); i++) {
+        if (slot[spear_pattern_rows[q][i]] == -1) {
+          slot[spear_pattern_rows[q][i]] = members.size ();
+          members.push_back (spear_pattern_rows[q][i]);
+        }
+      }
+    }
+
+    //  Rank each row once under this mask
+    vector<VECT*> cache (members.size (), NULL);
+    int num_members = static_cast<int> (members.size ());
+    int r = 0;
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (getThreads ())
+#endif
+    for (r = 0; r < num_members; r++) {
+      cache[r] = rankMasked (data.getRow (members[r]), spear_masks[g]);
+    }
+
+    //  Every pair in the group; each one is written to its own cells
+    int num_items = static_cast<int> (items.size ());
+    int t = 0;
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (getThreads ())
+#endif
+    for (t = 0; t < num_items; t++) {
+      const pair<unsigned int, unsigned int> &patterns = spear_groups[g][items[t].first];
+      const vector<unsigned int> &left = spear_pattern_rows[patterns.first];
+      const vector<unsigned int> &right = spear_pattern_rows[patterns.second];
+      unsigned int a = items[t].second;
+      for (unsigned int b = ((patterns.first == patterns.second) ? a + 1 : 0); b < right.size (); b++) {
+        unsigned int lo = (left[a] < right[b]) ? left[a] : right[b];
+        unsigned int hi = (left[a] < right[b]) ? right[b] : left[a];
+        if ((hi < first_new) || (hi < column_begin) || (hi >= column_end)) {
+          continue;
+        }
+        double score = cache[slot[lo]] -> getRow ().simPear<NULLS_NONE> (cache[slot[hi]] -> getRow ());
+        storeDistance (lo, hi, score);
+      }
+    }
+
+    for (k = 0; k < members.size (); k++) {
+      delete cache[k];
+      slot[members[k]] = -1;
+    }
+  }
+
+  return;
+}
@@ -0,0 +1,421 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file calculate_stream.cpp
+    Additional member functions for BUILDMST class definition
+      Out-of-core distances for --stream-columns
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <fstream>  //  ifstream
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+
+#include <algorithm>  //  min
+
+#include <cstdint>  //  uint64_t
+#include <cstdio>  //  EOF
+#include <cfloat>  //  DBL_MAX
+#include <cmath>  //  sqrt
+
+#include <boost/tokenizer.hpp>
+#include <boost/lexical_cast.hpp>
+
+using namespace std;
+using namespace boost;
+
+#include "BuildMSTConfig.hpp"
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+/*!
+     With --stream-columns C, the microarray data file is never held in
+     memory.  Instead, C columns (probes) of every row are read at a time
+     and, for every pair of rows, the sums that the distance method needs
+     are added up over the pairwise-complete columns:
+
+       - euclidean:  squared differences and the count
+       - manhattan:  absolute differences and the count
+       - pearson:  cross products, sums, sums of squares and the count
+       - cosine:  cross products (and the sum of squares of each row)
+       - uncentered:  cross products and sums of squares
+
+     The distances are derived from the sums once the last chunk has been
+     read, as if by calculateDistance (), and the rest of the program then
+     carries on as with --distance-matrix.  So, the memory needed is that
+     of the sums (M * M / 2 pairs) plus one chunk (M * C), rather than
+     M * N.  The sums are added up chunk by chunk, so the distances may
+     differ from those of the whole rows in the last few bits.
+
+     The file position of each row is remembered between chunks, so the
+     file is read once in all.
+*/
+
+
+//!  Read the next tab-separated field of a line
+/*!
+     \param buf The file, positioned at the start of the field (or at a tab)
+     \param field Filled with the field
+     \return Whether or not there was a field before the end of the line
+
+     Empty fields are skipped, as with the tokenizer in
+     EXPRMATRIX::parseRow ().  The end of the line is not consumed.
+*/
+static bool readField (streambuf *buf, string &field) {
+  field.clear ();
+  while (true) {
+    int c = buf -> sgetc ();
+    if ((c == EOF) || (c == '\n')) {
+      break;
+    }
+    buf -> sbumpc ();
+    if (c == '\t') {
+      if (!field.empty ()) {
+        break;
+      }
+      continue;
+    }
+    field.push_back (static_cast<char> (c));
+  }
+
+  return (!field.empty ());
+}
+
+
+//!  Number of sums kept for each pair of rows by --stream-columns
+unsigned int BUILDMST::streamSums () const {
+  switch (getDistance ()) {
+    case DIST_EUC :
+    case DIST_MAN :
+      return 2;
+    case DIST_PEAR :
+      return 6;
+    case DIST_COSINE :
+      return 1;
+    case DIST_UNCENTERED :
+      return 3;
+    default :
+      break;
+  }
+
+  return 0;
+}
+
+
+//!  Add the sums over one chunk of columns into the sums of every pair of rows
+/*!
+     \param chunk The chunk of columns of every row
+     \param sums The sums of each pair, row by row above the diagonal
+     \param squares The sum of squares of each row over its non-null columns (cosine only)
+
+     P is the NULL profile of the chunk.  Each thread adds up the pairs of
+     whole rows, so no two threads write to the same sums.
+*/
+template <NULL_PROFILE P>
+void BUILDMST::accumulateChunk (const EXPRMATRIX &chunk, vector<double> &sums, vector<double> &squares) {
+  unsigned int m = chunk.getM ();
+  unsigned int n = chunk.getN ();
+  unsigned int k = streamSums ();
+  int i = 0;
+
+#if HAVE_OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (getThreads ())
+#endif
+  for (i = 0; i < static_cast<int> (m); i++) {
+    double lanes[5 * SIMD_LANES];
+    EXPRROW x = chunk.getRow (i);
+    double *out = &sums[(static_cast<size_t> (i) * (2 * m - i - 1) / 2) * k];
+
+    if (getDistance () == DIST_COSINE) {
+      sumDot<P> (x.getExprs (), x.getNulls (), x.getExprs (), x.getNulls (), n, lanes);
+      squares[i] += sumLanes (lanes);
+    }
+
+    for (unsigned int j = i + 1; j < m; j++, out += k) {
+      EXPRROW y = chunk.getRow (j);
+      double count = (P == NULLS_NONE) ? n : countNonNull (x.getNulls (), y.getNulls (), x.getWords ());
+
+      switch (getDistance ()) {
+        case DIST_EUC :
+          sumSqDiff<P> (x.getExprs (), x.getNulls (), y.getExprs (), y.getNulls (), n, lanes);
+          out[0] += sumLanes (lanes);
+          out[1] += count;
+          break;
+        case DIST_MAN :
+          sumAbsDiff<P> (x.getExprs (), x.getNulls (), y.getExprs (), y.getNulls (), n, lanes);
+          out[0] += sumLanes (lanes);
+          out[1] += count;
+          break;
+        case DIST_PEAR :
+          sumPearson<P> (x.getExprs (), x.getNulls (), y.getExprs (), y.getNulls (), n, lanes);
+          for (unsigned int s = 0; s < 5; s++) {
+            out[s] += sumLanes (lanes + s * SIMD_LANES);
+          }
+          out[5] += count;
+          break;
+        case DIST_COSINE :
+          sumDot<P> (x.getExprs (), x.getNulls (), y.getExprs (), y.getNulls (), n, lanes);
+          out[0] += sumLanes (lanes);
+          break;
+        case DIST_UNCENTERED :
+          sumUncentered<P> (x.getExprs (), x.getNulls (), y.getExprs (), y.getNulls (), n, lanes);
+          for (unsigned int s = 0; s < 3; s++) {
+            out[s] += sumLanes (lanes + s * SIMD_LANES);
+          }
+          break;
+        default :
+          break;
+      }
+    }
+  }
+}
+
+
+//!  Derive the distance between a pair of rows from its sums
+/*!
+     \param sums The sums of the pair (see streamSums ())
+     \param norm1 The norm of the first row (cosine only)
+     \param norm2 The norm of the second row (cosine only)
+     \return The distance, as calculated by calculateDistance ()
+*/
+double BUILDMST::finishStream (const double *sums, double norm1, double norm2) const {
+  double num = 0.0;
+  double den1 = 0.0;
+  double den2 = 0.0;
+
+  switch (getDistance ()) {
+    case DIST_EUC :
+      return ((sums[1] == 0) ? DBL_MAX : sqrt (sums[0]));
+    case DIST_MAN :
+      return ((sums[1] == 0) ? DBL_MAX : sums[0]);
+    case DIST_PEAR :
+      num = (sums[5] * sums[0]) - (sums[1] * sums[2]);
+      den1 = (sums[5] * sums[3]) - (sums[1] * sums[1]);
+      den2 = (sums[5] * sums[4]) - (sums[2] * sums[2]);
+      return ((den1 * den2 == 0) ? 2.0 : 1 - num / sqrt (den1 * den2));
+    case DIST_COSINE :
+      return ((norm1 * norm2 == 0) ? 2.0 : 1 - sums[0] / (norm1 * norm2));
+    case DIST_UNCENTERED :
+      den1 = sqrt (sums[1] * sums[2]);
+      return ((den1 == 0) ? 2.0 : 1 - sums[0] / den1);
+    default :
+      break;
+  }
+
+  return 0.0;
+}
+
+
+//!  Read the microarray data file a chunk of columns at a time and calculate every distance
+/*!
+     \return Whether or not the file was read without errors
+
+     The file must be laid out as for readMicroarray ().  Only the names of
+     the experiments are kept in the expression matrix, which has no
+     columns, and the distances are stored into the distance matrix.
+*/
+bool BUILDMST::streamMicroarray () {
+  unsigned int m = 0;
+  unsigned int n = 0;
+  unsigned int i = 0;
+  unsigned int j = 0;
+  unsigned int chunks = 0;
+  string str;
+  vector<streampos> positions;
+
+  ifstream ma_fp (getMicroarrayFn ().c_str (), ios::in);
+  if (!ma_fp) {
+    cerr << "==\tError:  Input file " << getMicroarrayFn () << " could not be opened!" << endl;
+    return false;
+  }
+  getline (ma_fp, str);
+  if (ma_fp.eof ()) {
+    cerr << "Error:  Failed opening microarray data for reading!" << endl;
+    return false;
+  }
+
+  //  First pass:  find the start of each row and count the columns of the first row
+  while (true) {
+    streampos start = ma_fp.tellg ();
+    getline (ma_fp, str);
+    if (ma_fp.eof ()) {
+      break;
+    }
+
+    if (m == 0) {
+      typedef tokenizer<char_separator<char> > tokenizer;
+      char_separator<char> sep ("\t");
+      tokenizer tokens (str, sep);
+
+      for (tokenizer::iterator beg = tokens.begin (); beg != tokens.end (); ++beg) {
+        n++;
+      }
+      //  Do not count the name of the experiment
+      if (n > 0) {
+        n--;
+      }
+    }
+    positions.push_back (start);
+    m++;
+  }
+  ma_fp.clear ();
+
+  //  Only the names are kept
+  data.allocate (m, 0);
+  for (i = 0; i < m; i++) {
+    ma_fp.seekg (positions[i]);
+    readField (ma_fp.rdbuf (), str);
+    data.setName (i, str);
+    positions[i] = ma_fp.tellg ();
+  }
+  setM (m);
+  setN (0);
+  openDistances ();
+
+  unsigned int k = streamSums ();
+  size_t pairs = (m < 2) ? 0 : static_cast<size_t> (m) * (m - 1) / 2;
+  vector<double> sums (pairs * k, 0.0);
+  vector<double> squares (m, 0.0);
+  EXPRMATRIX chunk;
+
+  for (unsigned int first = 0; first < n; first += getStreamColumns ()) {
+    unsigned int width = min (getStreamColumns (), n - first);
+    if (chunk.getN () != width) {
+      chunk.allocate (m, width);
+    }
+
+    for (i = 0; i < m; i++) {
+      ma_fp.seekg (positions[i]);
+      for (j = 0; j < width; j++) {
+        if (!readField (ma_fp.rdbuf (), str)) {
+          cerr << "Error:  Mismatch in vector dimensions -- " << n << " vs " << first + j << endl;
+          return false;
+        }
+        if (str == "NULL") {
+          chunk.putExpr (i, j, NULL_EXPR);
+          chunk.putNull (i, j, true);
+          continue;
+        }
+        try {
+          chunk.putExpr (i, j, lexical_cast<double> (str));
+          chunk.putNull (i, j, false);
+        }
+        catch (bad_lexical_cast &) {
+          cerr << "\nUnexpected error in reading in microarray data.\nExpecting the keyword \"NULL\" or a double value, but found this instead:  " << str << "\nExiting...\n\n";
+          return false;
+        }
+      }
+      positions[i] = ma_fp.tellg ();
+    }
+    chunk.profileNulls ();
+
+    switch (chunk.getProfile ()) {
+      case NULLS_NONE :
+        accumulateChunk<NULLS_NONE> (chunk, sums, squares);
+        break;
+      case NULLS_SPARSE :
+        accumulateChunk<NULLS_SPARSE> (chunk, sums, squares);
+        break;
+      case NULLS_GENERAL :
+        accumulateChunk<NULLS_GENERAL> (chunk, sums, squares);
+        break;
+    }
+    chunks++;
+  }
+
+  //  Every row must end after its n columns
+  for (i = 0; i < m; i++) {
+    ma_fp.seekg (positions[i]);
+    unsigned int count = n;
+    while (readField (ma_fp.rdbuf (), str)) {
+      count++;
+    }
+    if (count != n) {
+      cerr << "Error:  Mismatch in vector dimensions -- " << n << " vs " << count << endl;
+      return false;
+    }
+  }
+  ma_fp.close ();
+
+  const double *pair = sums.empty () ? NULL : &sums[0];
+  for (i = 0; i < m; i++) {
+    for (j = i + 1; j < m; j++, pair += k) {
+      storeDistance (i, j, finishStream (pair, sqrt (squares[i]), sqrt (squares[j])));
+    }
+  }
+
+  //  Complete the file, if the matrix is memory-mapped
+  if (getPrecision () == PREC_FLOAT) {
+    dist_float.finish ();
+  }
+  else {
+    dist_double.finish ();
+  }
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tMicroarray dimensions:" << m << " by " << n << " (streamed)" << endl;
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tColumn chunks:" << chunks << " of at most " << getStreamColumns () << endl;
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tSums per pair:" << k << " (" << sums.size () * sizeof (double) << " bytes)" << endl;
+  }
+
+  return true;
+}
+
+//  Instantiate the chunk sums for each NULL profile
+template void BUILDMST::accumulateChunk<NULLS_NONE> (const EXPRMATRIX &chunk, vector<double> &sums, vector<double> &squares);
+template void BUILDMST::accumulateChunk<NULLS_SPARSE> (const EXPRMATRIX &chunk, vector<double> &sums, vector<double> &squares);
+template void BUILDMST::accumulateChunk<NULLS_GENERAL> (const EXPRMATRIX &chunk, vector<double> &sums, vector<double> &squares);
+
@@ -55,11 +55,15 @@
 
 using namespace std;
 
+#include <cstdint>  //  uint64_t
 #include <cstdlib>  //  exit, EXIT_FAILURE
 
 #include "global_defn.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
 #include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
 #include "cluster.hpp"
 
 //!  Default constructor; should never be called (not needed)
@@ -80,16 +84,18 @@ CLUSTER::CLUSTER ()
      \param arg1 The name of this cluster
      \param arg2 The colour of this cluster
      \param arg3 The shape of this cluster
-     \param arg4 The VECT object for this cluster of one item
+
+     The centroid of a cluster of one item is its row in the expression
+     matrix, so no VECT object is kept.
 */
-CLUSTER::CLUSTER (unsigned int arg_id, string arg1, string arg2, string arg3, VECT arg4)
+CLUSTER::CLUSTER (unsigned int arg_id, string arg1, string arg2, string arg3)
   : id (arg_id),
     name (arg1),
     colour (arg2),
     shape (arg3),
     items (),
     ancestors (false),
-    centroid (arg4)
+    centroid ()
 {
   //  Add the item in; cluster of size 1
   items.push_back (arg_id);
@@ -102,6 +108,7 @@ CLUSTER::CLUSTER (unsigned int arg_id, string arg1, string arg2, string arg3, VE
      \param arg2 The second cluster
      \param arg3 The linkage method being used
      \param arg4 Number of experiments in microarray (for naming)
+     \param arg5 The expression matrix (for centroids of clusters of one item)
 
      This constructor sets the attributes of the cluster and
      if centroid linkage is used, calls formCentroid () to build
@@ -109,7 +116,7 @@ CLUSTER::CLUSTER (unsigned int arg_id, string arg1, string arg2, string arg3, VE
 
      Note:  There is no order to clusters so arg1 and arg2 can be swapped.
 */
-CLUSTER::CLUSTER (unsigned int arg_id, CLUSTER *arg1, CLUSTER *arg2, LINK_METHOD arg3, unsigned int arg4)
+CLUSTER::CLUSTER (unsigned int arg_id, CLUSTER *arg1, CLUSTER *arg2, LINK_METHOD arg3, unsigned int arg4, const EXPRMATRIX *arg5)
   : id (arg_id),
     name (""),
     colour (""),
@@ -158,7 +165,7 @@ CLUSTER::CLUSTER (unsigned int arg_id, CLUSTER *arg1, CLUSTER *arg2, LINK_METHOD
 
   //  Centroid linkage is being used, so we need to form a centroid vector
   if (arg3 == LINK_CENTROID) {
-    formCentroid (arg1, arg2);
+    formCentroid (arg1, arg2, arg5);
   }
 }
 
@@ -215,11 +222,11 @@ void CLUSTER::setAncestors () {
      that the sum of any value with NULL is NULL.  The centroid
      vector is stored as a VECT object.
 */
-void CLUSTER::formCentroid (CLUSTER *a, CLUSTER *b) {
-  unsigned int a_len = (a -> getCentroid ()).getN ();
-  unsigned int b_len = (b -> getCentroid ()).getN ();
-  VECT a_vect = a -> getCentroid ();
-  VECT b_vect = b -> getCentroid ();
+void CLUSTER::formCentroid (CLUSTER *a, CLUSTER *b, const EXPRMATRIX *data) {
+  EXPRROW a_row = a -> getCentroid (data);
+  EXPRROW b_row = b -> getCentroid (data);
+  unsigned int a_len = a_row.getN ();
+  unsigned int b_len = b_row.getN ();
 
   if (a_len != b_len) {
     cerr << "Error:  Number of columns differ! (" << a_len << ", " << b_len << ")" << endl;
@@ -231,12 +238,12 @@ void CLUSTER::formCentroid (CLUSTER *a, CLUSTER *b) {
 
   for (unsigned int i = 0; i < a_len; i++) {
     //  If either is NULL, make this one NULL too
-    if (a_vect.isNull (i) || b_vect.isNull (i)) {
+    if (a_row.isNull (i) || b_row.isNull (i)) {
       centroid.putExpr (i, 0);
       centroid.putNull (i, true);
     }
     else {
-      centroid.putExpr (i, (((a_len * a_vect.getExpr (i)) + (b_len * b_vect.getExpr (i))) / (a_len + b_len)));
+      centroid.putExpr (i, (((a_len * a_row.getExpr (i)) + (b_len * b_row.getExpr (i))) / (a_len + b_len)));
       centroid.putNull (i, false);
     }
   }
@@ -245,8 +252,18 @@ void CLUSTER::formCentroid (CLUSTER *a, CLUSTER *b) {
 }
 
 //!  Get the centroid vector from this cluster
-VECT CLUSTER::getCentroid () const {
-  return centroid;
-}
+/*!
+     \param data The expression matrix
 
+     A cluster of one item has its row in the expression matrix as its
+     centroid.  The view that is returned must not outlive this cluster
+     (or the matrix).
+*/
+EXPRROW CLUSTER::getCentroid (const EXPRMATRIX *data) const {
+  if (items.size () == 1) {
+    return (data -> getRow (items[0]));
+  }
+
+  return (centroid.getRow ());
+}
 
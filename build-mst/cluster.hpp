@@ -74,8 +74,8 @@
 class CLUSTER {
   public:
     CLUSTER ();
-    CLUSTER (unsigned int arg_id, string arg1, string arg2, string arg3, VECT arg4);
-    CLUSTER (unsigned int arg_id, CLUSTER *arg1, CLUSTER *arg2, LINK_METHOD arg3, unsigned int arg4);
+    CLUSTER (unsigned int arg_id, string arg1, string arg2, string arg3);
+    CLUSTER (unsigned int arg_id, CLUSTER *arg1, CLUSTER *arg2, LINK_METHOD arg3, unsigned int arg4, const EXPRMATRIX *arg5);
 
     //  Accessors
     void setName (string arg);
@@ -88,18 +88,21 @@ class CLUSTER {
     vector<unsigned int> getItems () const;
 
     //  Other functions
-    inline bool haveAncestors () {
+    inline bool haveAncestors () const {
       return ancestors;
     }
     void setAncestors ();
-    void formCentroid (CLUSTER *a, CLUSTER *b);
-    VECT getCentroid () const;
+    void formCentroid (CLUSTER *a, CLUSTER *b, const EXPRMATRIX *data);
+    EXPRROW getCentroid (const EXPRMATRIX *data) const;
 
     //  Linkage functions  [cluster_link.cpp]
-    double linkSingle (CLUSTER *other, double **d);
-    double linkAverage (CLUSTER *other, double **d);
-    double linkComplete (CLUSTER *other, double **d);
-    double linkCentroid (CLUSTER *other, vector<VECT> *data, enum DIST_METHOD distance);
+    template <typename T>
+    T linkSingle (CLUSTER *other, const DISTMATRIX<T> *d);
+    template <typename T>
+    T linkAverage (CLUSTER *other, const DISTMATRIX<T> *d);
+    template <typename T>
+    T linkComplete (CLUSTER *other, const DISTMATRIX<T> *d);
+    double linkCentroid (CLUSTER *other, const EXPRMATRIX *data, enum DIST_METHOD distance);
   private:
     //!  Numerical ID for this cluster.
     unsigned int id;
@@ -116,6 +119,8 @@ class CLUSTER {
          this cluster; default value FALSE for all clusters.  */
     bool ancestors;
     //!  The vector that represents the centroid of this cluster
+    /*!  Only formed for merged clusters when centroid linkage is used; the
+         centroid of a cluster of one item is its row in the expression matrix.  */
     VECT centroid;
 };
 
@@ -51,18 +51,23 @@
 #include <string>
 #include <vector>
 
-#include <cfloat>  //  DBL_MAX
+#include <cstdint>  //  uint64_t
+#include <limits>  //  numeric_limits
 
 using namespace std;
 
 #include "global_defn.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
 #include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
 #include "cluster.hpp"
 
 //!  The single linkage between this cluster and another one
-double CLUSTER::linkSingle (CLUSTER *other, double **d) {
-  double score = 0;
+template <typename T>
+T CLUSTER::linkSingle (CLUSTER *other, const DISTMATRIX<T> *d) {
+  T score = 0;
 
   vector<unsigned int> my_items = getItems ();
   unsigned int i = 0;  //  Position i
@@ -77,15 +82,15 @@ double CLUSTER::linkSingle (CLUSTER *other, double **d) {
   //  Initialization to the first pair
   expt_i = my_items[0];
   expt_j = other_items[0];
-  score = d[expt_i][expt_j];
+  score = d -> get (expt_i, expt_j);
 
   for (i = 0; i < max_i; i++) {
     expt_i = my_items[i];
     for (j = 0; j < max_j; j++) {
       expt_j = other_items[j];
       //  Take distance if smaller than the current score
-      if (d[expt_i][expt_j] < score) {
-        score = d[expt_i][expt_j];
+      if (d -> get (expt_i, expt_j) < score) {
+        score = d -> get (expt_i, expt_j);
       }
     }
   }
@@ -95,8 +100,9 @@ double CLUSTER::linkSingle (CLUSTER *other, double **d) {
 
 
 //!  The average linkage between this cluster and another one
-double CLUSTER::linkAverage (CLUSTER *other, double **d) {
-  double score = 0;
+template <typename T>
+T CLUSTER::linkAverage (CLUSTER *other, const DISTMATRIX<T> *d) {
+  T score = 0;
   unsigned int count = 0;
 
   vector<unsigned int> my_items = getItems ();
@@ -113,26 +119,27 @@ double CLUSTER::linkAverage (CLUSTER *other, double **d) {
     expt_i = my_items[i];
     for (j = 0; j < max_j; j++) {
       expt_j = other_items[j];
-      if (d[expt_i][expt_j] < score) {
-        score += d[expt_i][expt_j];
+      if (d -> get (expt_i, expt_j) < score) {
+        score += d -> get (expt_i, expt_j);
         count++;
       }
     }
   }
 
   if (count == 0) {
-    score = DBL_MAX;
+    score = numeric_limits<T>::max ();
   }
   else {
-    score = score / static_cast<double> (count);
+    score = score / static_cast<T> (count);
   }
 
   return score;
 }
 
 //!  The complete linkage between this cluster and another one
-double CLUSTER::linkComplete (CLUSTER *other, double **d) {
-  double score = 0;
+template <typename T>
+T CLUSTER::linkComplete (CLUSTER *other, const DISTMATRIX<T> *d) {
+  T score = 0;
 
   vector<unsigned int> my_items = getItems ();
   unsigned int i = 0;  //  Position i
@@ -147,15 +154,15 @@ double CLUSTER::linkComplete (CLUSTER *other, double **d) {
   //  Initialization to the first pair
   expt_i = my_items[0];
   expt_j = other_items[0];
-  score = d[expt_i][expt_j];
+  score = d -> get (expt_i, expt_j);
 
   for (i = 0; i < max_i; i++) {
     expt_i = my_items[i];
     for (j = 0; j < max_j; j++) {
       expt_j = other_items[j];
       //  Take distance if larger than the current score
-      if (d[expt_i][expt_j] > score) {
-        score = d[expt_i][expt_j];
+      if (d -> get (expt_i, expt_j) > score) {
+        score = d -> get (expt_i, expt_j);
       }
     }
   }
@@ -171,22 +178,35 @@ double CLUSTER::linkComplete (CLUSTER *other, double **d) {
      using the Euclidean distance may be preferred, but
      that is up to the user.
 */
-double CLUSTER::linkCentroid (CLUSTER *other, vector<VECT> *data, enum DIST_METHOD distance) {
+double CLUSTER::linkCentroid (CLUSTER *other, const EXPRMATRIX *data, enum DIST_METHOD distance) {
   double score = 0;
-  VECT temp = other -> getCentroid ();
+  EXPRROW mine = getCentroid (data);
+  EXPRROW temp = other -> getCentroid (data);
 
   switch (distance) {
     case DIST_EUC :
-      score = getCentroid ().simEuc (&temp);
+      score = mine.simEuc (temp);
       break;
     case DIST_MAN :
-      score = getCentroid ().simMan (&temp);
+      score = mine.simMan (temp);
       break;
     case DIST_PEAR :
-      score = getCentroid ().simPear (&temp);
+      score = mine.simPear (temp);
       break;
     case DIST_SPEAR :
-      score = getCentroid ().simSpear (&temp);
+      score = mine.simSpear (temp);
+      break;
+    case DIST_KENDALL :
+      score = mine.simKendall (temp);
+      break;
+    case DIST_COSINE :
+      score = mine.simCosine (temp, mine.getNorm (), temp.getNorm ());
+      break;
+    case DIST_UNCENTERED :
+      score = mine.simUncentered (temp, mine.getNorm (), temp.getNorm ());
+      break;
+    case DIST_MI :
+      score = mine.simMutualInfo (temp);
       break;
     default :
       break;
@@ -195,3 +215,10 @@ double CLUSTER::linkCentroid (CLUSTER *other, vector<VECT> *data, enum DIST_METH
   return score;
 }
 
+//  Instantiate the linkage functions for each precision of the distance matrix
+template float CLUSTER::linkSingle (CLUSTER *other, const DISTMATRIX<float> *d);
+template double CLUSTER::linkSingle (CLUSTER *other, const DISTMATRIX<double> *d);
+template float CLUSTER::linkAverage (CLUSTER *other, const DISTMATRIX<float> *d);
+template double CLUSTER::linkAverage (CLUSTER *other, const DISTMATRIX<double> *d);
+template float CLUSTER::linkComplete (CLUSTER *other, const DISTMATRIX<float> *d);
+template double CLUSTER::linkComplete (CLUSTER *other, const DISTMATRIX<double> *d);
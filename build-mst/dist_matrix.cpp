@@ -0,0 +1,395 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file dist_matrix.cpp
+    Member functions for DISTMATRIX class definition
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <fstream>  //  ifstream
+#include <string>
+#include <new>  //  nothrow
+#include <cstdlib>  //  exit, EXIT_FAILURE
+#include <vector>
+#include <cstring>  //  memcpy, memcmp
+#include <cstdint>  //  uint32_t
+
+#include <fcntl.h>  //  open
+#include <unistd.h>  //  ftruncate, close
+#include <sys/stat.h>  //  fstat
+#include <sys/mman.h>  //  mmap, munmap, msync
+
+using namespace std;
+
+#include "global_defn.hpp"
+#include "dist_matrix.hpp"
+
+//!  Default constructor; the matrix is empty until allocate () or allocateFile () is called
+template <typename T>
+DISTMATRIX<T>::DISTMATRIX ()
+  : m (0),
+    values (NULL),
+    offset (0),
+    mapping (NULL),
+    mapping_bytes (0),
+    mapping_fn ("")
+{
+}
+
+//!  Destructor that releases the distances
+template <typename T>
+DISTMATRIX<T>::~DISTMATRIX () {
+  release ();
+}
+
+//!  Allocate space in memory for the distances between every pair of experiments
+/*!
+     \param arg Number of experiments
+
+     Every distance is initially 0.  Any existing contents are discarded.
+*/
+template <typename T>
+void DISTMATRIX<T>::allocate (unsigned int arg) {
+  size_t total = capacity (arg);
+
+  release ();
+  m = arg;
+  values = new (nothrow) T[total];
+  if (values == NULL) {
+    cerr << "Error:  Could not allocate memory for the distance matrix (" << total << " pairs)!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  for (size_t k = 0; k < total; k++) {
+    values[k] = 0;
+  }
+}
+
+//!  Allocate space in memory for the distances in a range of columns
+/*!
+     \param arg Number of experiments
+     \param first The first column (a multiple of DIST_MATRIX_TILE_ROWS)
+     \param last One past the last column (a multiple of DIST_MATRIX_TILE_ROWS, or arg)
+
+     Only the pairs (i, j) with i < j and first <= j < last can be read
+     and written.  Every distance is initially 0.  Any existing contents
+     are discarded.
+*/
+template <typename T>
+void DISTMATRIX<T>::allocateColumns (unsigned int arg, unsigned int first, unsigned int last) {
+  size_t total = countColumns (first, last);
+
+  release ();
+  m = arg;
+  offset = capacity (first);
+  values = new (nothrow) T[total];
+  if (values == NULL) {
+    cerr << "Error:  Could not allocate memory for the distance matrix (" << total << " pairs)!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  for (size_t k = 0; k < total; k++) {
+    values[k] = 0;
+  }
+}
+
+//!  Allocate space in a memory-mapped file for the distances between every pair of experiments
+/*!
+     \param arg Number of experiments
+     \param fn Name of the file, which is created or overwritten
+     \param tag Words that identify what the distances were calculated from (see makeHeader ())
+     \param rows One word per experiment that identifies what it was calculated from (or none)
+
+     The file starts with a header of DIST_FILE_HEADER_BYTES bytes, the
+     tiles follow and the words in rows are at the end.  The file is
+     extended with zeroes, so every distance is initially 0 and disk space
+     is only used as the distances are written.  The magic number in the
+     header is only written by finish (), so a file that was not completed
+     is never mapped by mapFile ().  Any existing contents of the matrix
+     are discarded.
+*/
+template <typename T>
+void DISTMATRIX<T>::allocateFile (unsigned int arg, string fn, const vector<uint64_t> &tag, const vector<uint64_t> &rows) {
+  size_t total = capacity (arg);
+  size_t bytes = DIST_FILE_HEADER_BYTES + total * sizeof (T) + rows.size () * sizeof (uint64_t);
+  vector<char> header = makeHeader (arg, tag, rows.size ());
+
+  release ();
+  m = arg;
+
+  int fd = open (fn.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    cerr << "Error:  Could not create the distance matrix file " << fn << "!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  if (ftruncate (fd, bytes) != 0) {
+    cerr << "Error:  Could not extend the distance matrix file " << fn << " to " << bytes << " bytes!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  void *ptr = mmap (NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  if (ptr == MAP_FAILED) {
+    cerr << "Error:  Could not map the distance matrix file " << fn << " into memory!" << endl;
+    exit (EXIT_FAILURE);
+  }
+
+  mapping = ptr;
+  mapping_bytes = bytes;
+  mapping_fn = fn;
+  //  Everything except the magic number
+  memcpy (static_cast<char*> (mapping) + sizeof (uint32_t), &header[sizeof (uint32_t)], header.size () - sizeof (uint32_t));
+  values = reinterpret_cast<T*> (static_cast<char*> (mapping) + DIST_FILE_HEADER_BYTES);
+  if (!rows.empty ()) {
+    memcpy (values + total, &rows[0], rows.size () * sizeof (uint64_t));
+  }
+}
+
+//!  Map the distances from a file that was completed by an earlier run
+/*!
+     \param arg Number of experiments
+     \param fn Name of the file
+     \param tag Words that identify what the distances were calculated from (see makeHeader ())
+     \param rows One word per experiment that identifies what it was calculated from (or none)
+     \return Whether or not the file exists and its header and rows match; if not, the matrix is left empty
+
+     The file is mapped read-only, so set () must not be called unless
+     detach () is called first.
+*/
+template <typename T>
+bool DISTMATRIX<T>::mapFile (unsigned int arg, string fn, const vector<uint64_t> &tag, const vector<uint64_t> &rows) {
+  size_t total = capacity (arg);
+  size_t bytes = DIST_FILE_HEADER_BYTES + total * sizeof (T) + rows.size () * sizeof (uint64_t);
+  vector<char> header = makeHeader (arg, tag, rows.size ());
+  struct stat info;
+
+  release ();
+
+  int fd = open (fn.c_str (), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  if ((fstat (fd, &info) != 0) || (static_cast<size_t> (info.st_size) != bytes)) {
+    close (fd);
+    return false;
+  }
+  void *ptr = mmap (NULL, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (ptr == MAP_FAILED) {
+    return false;
+  }
+  T *ptr_values = reinterpret_cast<T*> (static_cast<char*> (ptr) + DIST_FILE_HEADER_BYTES);
+  if ((memcmp (ptr, &header[0], header.size ()) != 0) ||
+      ((!rows.empty ()) && (memcmp (ptr_values + total, &rows[0], rows.size () * sizeof (uint64_t)) != 0))) {
+    munmap (ptr, bytes);
+    return false;
+  }
+
+  m = arg;
+  mapping = ptr;
+  mapping_bytes = bytes;
+  mapping_fn = fn;
+  values = ptr_values;
+
+  return true;
+}
+
+//!  Read the header and the rows of a file that was completed by an earlier run
+/*!
+     \param fn Name of the file
+     \param arg Number of experiments
+     \param tag Words that identify what the distances were calculated from
+     \param rows One word per experiment that identifies what it was calculated from (or none)
+     \return Whether or not the file is a completed distance matrix file with the same precision and tiles
+
+     The file can then be mapped with mapFile ().
+*/
+template <typename T>
+bool DISTMATRIX<T>::readHeader (string fn, unsigned int &arg, vector<uint64_t> &tag, vector<uint64_t> &rows) {
+  uint32_t fields[6];
+
+  ifstream fp (fn.c_str (), ios::in | ios::binary);
+  if (!fp) {
+    return false;
+  }
+  fp.read (reinterpret_cast<char*> (fields), sizeof (fields));
+  if ((!fp) || (fields[0] != DIST_FILE_MAGIC) || (fields[1] != sizeof (T)) || (fields[3] != DIST_MATRIX_TILE_BITS) ||
+      (sizeof (fields) + fields[4] * sizeof (uint64_t) > DIST_FILE_HEADER_BYTES)) {
+    return false;
+  }
+
+  arg = fields[2];
+  tag.assign (fields[4], 0);
+  rows.assign (fields[5], 0);
+  if (!tag.empty ()) {
+    fp.read (reinterpret_cast<char*> (&tag[0]), tag.size () * sizeof (uint64_t));
+  }
+  if (!rows.empty ()) {
+    fp.seekg (DIST_FILE_HEADER_BYTES + capacity (arg) * sizeof (T), ios::beg);
+    fp.read (reinterpret_cast<char*> (&rows[0]), rows.size () * sizeof (uint64_t));
+  }
+
+  return (static_cast<bool> (fp));
+}
+
+//!  Copy the distances of a smaller matrix
+/*!
+     \param src A matrix whose experiments are the first ones of this matrix
+
+     Since the columns for experiments added to the end of the matrix are
+     appended after the existing ones, the tiles of src are the first
+     tiles of this matrix.  Pairs involving the experiments after those of
+     src are left as they are.
+*/
+template <typename T>
+void DISTMATRIX<T>::copy (const DISTMATRIX<T> &src) {
+  size_t total = capacity (src.m);
+
+  if (src.m > m) {
+    cerr << "Error:  Cannot copy a distance matrix of " << src.m << " experiments into one of " << m << "!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  memcpy (values, src.values, total * sizeof (T));
+}
+
+//!  Complete a memory-mapped file once every distance has been written
+/*!
+     The tiles are flushed to disk before the magic number is written, so
+     that the file can be mapped again by mapFile ().  Nothing is done if
+     the matrix is in memory.
+*/
+template <typename T>
+void DISTMATRIX<T>::finish () {
+  uint32_t magic = DIST_FILE_MAGIC;
+
+  if (mapping == NULL) {
+    return;
+  }
+  msync (mapping, mapping_bytes, MS_SYNC);
+  memcpy (mapping, &magic, sizeof (magic));
+  msync (mapping, DIST_FILE_HEADER_BYTES, MS_SYNC);
+}
+
+//!  Keep the distances set from now on in memory instead of writing them to the file
+/*!
+     The file is mapped again, copy-on-write, at the same address, so only
+     the pages that are changed by set () take up memory and the file keeps
+     the distances it had (e.g., the lower bounds of --quantize in a cache
+     entry).  Nothing is done if the matrix is in memory.
+*/
+template <typename T>
+void DISTMATRIX<T>::detach () {
+  if (mapping == NULL) {
+    return;
+  }
+
+  int fd = open (mapping_fn.c_str (), O_RDONLY);
+  if (fd == -1) {
+    cerr << "Error:  Could not open the distance matrix file " << mapping_fn << " again!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  void *ptr = mmap (mapping, mapping_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+  close (fd);
+  if (ptr == MAP_FAILED) {
+    cerr << "Error:  Could not map the distance matrix file " << mapping_fn << " into memory again!" << endl;
+    exit (EXIT_FAILURE);
+  }
+}
+
+//!  Make the header of a distance matrix file
+/*!
+     \param arg Number of experiments
+     \param tag Words that identify what the distances were calculated from
+     \param rows Number of words at the end of the file (0 or arg)
+     \return The used part of the header
+
+     The header holds six 32-bit integers (DIST_FILE_MAGIC, the size of each
+     distance in bytes, the number of experiments, DIST_MATRIX_TILE_BITS,
+     the number of words in the tag, and the number of words at the end of
+     the file) followed by the tag as 64-bit integers.  The rest of the
+     DIST_FILE_HEADER_BYTES bytes are 0.
+*/
+template <typename T>
+vector<char> DISTMATRIX<T>::makeHeader (unsigned int arg, const vector<uint64_t> &tag, size_t rows) {
+  uint32_t fields[6] = {DIST_FILE_MAGIC, static_cast<uint32_t> (sizeof (T)), arg, DIST_MATRIX_TILE_BITS, static_cast<uint32_t> (tag.size ()), static_cast<uint32_t> (rows)};
+  vector<char> header (sizeof (fields) + tag.size () * sizeof (uint64_t));
+
+  if (header.size () > DIST_FILE_HEADER_BYTES) {
+    cerr << "Error:  The tag of the distance matrix file does not fit in its header!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  memcpy (&header[0], fields, sizeof (fields));
+  if (!tag.empty ()) {
+    memcpy (&header[sizeof (fields)], &tag[0], tag.size () * sizeof (uint64_t));
+  }
+
+  return header;
+}
+
+//!  Number of distances in the tiles on or above the diagonal for arg experiments
+template <typename T>
+size_t DISTMATRIX<T>::capacity (unsigned int arg) {
+  size_t tiles = (static_cast<size_t> (arg) + DIST_MATRIX_TILE_ROWS - 1) >> DIST_MATRIX_TILE_BITS;
+
+  return ((tiles * (tiles + 1) / 2) << (2 * DIST_MATRIX_TILE_BITS));
+}
+
+//!  Release the distances, whether they are in memory or in a file
+template <typename T>
+void DISTMATRIX<T>::release () {
+  if (mapping != NULL) {
+    munmap (mapping, mapping_bytes);
+  }
+  else {
+    delete [] values;
+  }
+  m = 0;
+  values = NULL;
+  offset = 0;
+  mapping = NULL;
+  mapping_bytes = 0;
+  mapping_fn = "";
+}
+
+//  Instantiate the distance matrix for each precision
+template class DISTMATRIX<float>;
+template class DISTMATRIX<double>;
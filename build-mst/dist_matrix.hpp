@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file dist_matrix.hpp
+    Header file for DISTMATRIX class definition
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#ifndef DIST_MATRIX_HPP
+#define DIST_MATRIX_HPP
+
+/*!
+     The DISTMATRIX class holds the distance between every pair of
+     experiments.  Since distances are symmetric and the distance from
+     an experiment to itself is 0, only the pairs above the diagonal are
+     stored.
+
+     The matrix is split into square tiles with DIST_MATRIX_TILE_ROWS
+     rows along each side, and only the tiles on or above the diagonal
+     are kept.  Tiles are stored one after another, column of tiles by
+     column of tiles; within a tile, the distances are stored row by row.
+     So, reading the distances in row order touches one row of tiles at a
+     time and the columns for experiments added to the end of the matrix
+     are appended after the existing ones.
+
+     The tiles are either kept in memory (allocate ()) or in a
+     memory-mapped file (allocateFile ()), which the operating system
+     pages in and out as needed.  In both cases, the distances are read
+     and written through get () and set ().  A file that was completed
+     by finish () can be mapped again by a later run (mapFile ()) or
+     copied into a larger matrix (copy ()).  After detach (), the
+     distances set are only kept in memory and the file is left as it is.
+
+     The distances are calculated in double precision and stored as T,
+     so a matrix of floats (--precision float) needs half of the memory.
+
+     Since a column of tiles is contiguous, a range of columns can be kept
+     on its own (allocateColumns ()) and moved in one piece (getColumns ()),
+     which is how the distances calculated by other MPI processes are
+     gathered.
+*/
+template <typename T>
+class DISTMATRIX {
+  public:
+    DISTMATRIX ();
+    ~DISTMATRIX ();
+
+    void allocate (unsigned int arg);
+    void allocateColumns (unsigned int arg, unsigned int first, unsigned int last);
+    void allocateFile (unsigned int arg, string fn, const vector<uint64_t> &tag, const vector<uint64_t> &rows);
+    bool mapFile (unsigned int arg, string fn, const vector<uint64_t> &tag, const vector<uint64_t> &rows);
+    static bool readHeader (string fn, unsigned int &arg, vector<uint64_t> &tag, vector<uint64_t> &rows);
+    void copy (const DISTMATRIX<T> &src);
+    void finish ();
+    void detach ();
+
+    //!  Get the number of experiments
+    inline unsigned int getM () const {
+      return m;
+    }
+
+    //!  Get the distance between experiments i and j, in either order
+    inline T get (unsigned int i, unsigned int j) const {
+      if (i == j) {
+        return 0;
+      }
+      return (values[index (i, j) - offset]);
+    }
+
+    //!  Set the distance between experiments i and j (i != j), in either order
+    inline void set (unsigned int i, unsigned int j, double value) {
+      values[index (i, j) - offset] = static_cast<T> (value);
+    }
+
+    //!  Get the distances of the columns from first (a multiple of DIST_MATRIX_TILE_ROWS) onwards
+    inline T *getColumns (unsigned int first) {
+      return (values + capacity (first) - offset);
+    }
+
+    //!  Number of distances in the columns from first to last (both multiples of DIST_MATRIX_TILE_ROWS, or last = m)
+    static inline size_t countColumns (unsigned int first, unsigned int last) {
+      return (capacity (last) - capacity (first));
+    }
+  private:
+    //  Not copyable, since the matrix owns its buffer
+    DISTMATRIX (const DISTMATRIX<T> &src);
+    const DISTMATRIX<T> &operator= (const DISTMATRIX<T> &rhs);
+
+    static size_t capacity (unsigned int arg);
+    static vector<char> makeHeader (unsigned int arg, const vector<uint64_t> &tag, size_t rows);
+    void release ();
+
+    //!  Position of pair (i, j) in the tiles (i != j)
+    static inline size_t index (unsigned int i, unsigned int j) {
+      if (i > j) {
+        unsigned int temp = i;
+        i = j;
+        j = temp;
+      }
+      size_t tile_i = i >> DIST_MATRIX_TILE_BITS;
+      size_t tile_j = j >> DIST_MATRIX_TILE_BITS;
+      size_t tile = tile_j * (tile_j + 1) / 2 + tile_i;
+      return ((tile << (2 * DIST_MATRIX_TILE_BITS)) +
+        ((i & (DIST_MATRIX_TILE_ROWS - 1)) << DIST_MATRIX_TILE_BITS) +
+        (j & (DIST_MATRIX_TILE_ROWS - 1)));
+    }
+
+    //!  Number of experiments
+    unsigned int m;
+    //!  The tiles on or above the diagonal
+    T *values;
+    //!  Position of the first tile in values (not 0 if only some of the columns are kept)
+    size_t offset;
+    //!  Start of the memory-mapped file (NULL if the tiles are in memory)
+    void *mapping;
+    //!  Size of the memory-mapped file (in bytes)
+    size_t mapping_bytes;
+    //!  Name of the memory-mapped file (empty if the tiles are in memory)
+    string mapping_fn;
+};
+
+#endif
+
@@ -0,0 +1,349 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file expr_matrix.cpp
+    Member functions for EXPRMATRIX class definition
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <string>
+#include <vector>
+#include <utility>  //  swap
+#include <algorithm>  //  min
+#include <iostream>  //  cerr, endl
+#include <cstdlib>  //  posix_memalign, free, exit, EXIT_FAILURE
+#include <cstdint>  //  uint64_t
+
+#include <boost/tokenizer.hpp>
+#include <boost/lexical_cast.hpp>
+
+using namespace std;
+using namespace boost;
+
+#include "global_defn.hpp"
+#include "check.hpp"
+#include "vect_simd.hpp"
+#include "expr_row.hpp"
+#include "expr_matrix.hpp"
+
+//!  Default constructor; the matrix is empty until allocate () is called
+EXPRMATRIX::EXPRMATRIX ()
+  : m (0),
+    n (0),
+    stride (0),
+    words (0),
+    exprs (NULL),
+    nulls (NULL),
+    profiles (),
+    profile (NULLS_GENERAL),
+    norms (),
+    columns (),
+    names (),
+    colours (),
+    shapes ()
+{
+}
+
+//!  Destructor that releases the buffers
+EXPRMATRIX::~EXPRMATRIX () {
+  free (exprs);
+  free (nulls);
+}
+
+//!  Allocate space for the matrix
+/*!
+     \param arg1 Number of rows
+     \param arg2 Number of columns
+
+     Every expression level is initially 0 and flagged as NULL; rows are
+     filled in by parseRow (), and profileNulls () and calculateNorms ()
+     are called afterwards.
+     Any existing contents are discarded.
+*/
+void EXPRMATRIX::allocate (unsigned int arg1, unsigned int arg2) {
+  void *ptr = NULL;
+  size_t total = 0;
+
+  free (exprs);
+  free (nulls);
+  exprs = NULL;
+  nulls = NULL;
+
+  m = arg1;
+  n = arg2;
+  stride = ((arg2 + SIMD_LANES - 1) / SIMD_LANES) * SIMD_LANES;
+  words = (arg2 + NULL_WORD_BITS - 1) / NULL_WORD_BITS;
+
+  //  Allocate at least one element so that the pointers are never NULL
+  total = static_cast<size_t> (m) * stride;
+  if (posix_memalign (&ptr, 64, (total == 0 ? 1 : total) * sizeof (double)) != 0) {
+    cerr << "Error:  Could not allocate memory for the expression matrix (" << m << " by " << n << ")!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  exprs = static_cast<double*> (ptr);
+  for (size_t k = 0; k < total; k++) {
+    exprs[k] = 0.0;
+  }
+
+  total = static_cast<size_t> (m) * words;
+  if (posix_memalign (&ptr, 64, (total == 0 ? 1 : total) * sizeof (uint64_t)) != 0) {
+    cerr << "Error:  Could not allocate memory for the expression matrix (" << m << " by " << n << ")!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  nulls = static_cast<uint64_t*> (ptr);
+  for (size_t k = 0; k < total; k++) {
+    nulls[k] = ~static_cast<uint64_t> (0);
+  }
+
+  profiles.assign (m, NULLS_GENERAL);
+  profile = NULLS_GENERAL;
+  norms.assign (m, 0.0);
+  columns.clear ();
+  names.assign (m, "");
+  colours.assign (m, DEFAULT_COLOUR);
+  shapes.assign (m, DEFAULT_SHAPE);
+}
+
+//!  Fill in a row of the matrix from a line of the microarray data file
+/*!
+     \param i The row to fill in
+     \param arg The row from the microarray data file, represented as a string
+     \return The number of expression levels found on the line
+
+     The line is tab-separated, with the name of the experiment in the
+     first column.  Expression levels beyond the width of the matrix are
+     counted but not stored, so that the caller can report a mismatch.
+     If selectColumns () was called, only the selected columns are stored.
+*/
+unsigned int EXPRMATRIX::parseRow (unsigned int i, string arg) {
+  unsigned int j = 0;
+
+  typedef tokenizer<char_separator<char> > tokenizer;
+  char_separator<char> sep ("\t");  //  Must be tab-separated
+  tokenizer tokens (arg, sep);
+
+  //  Grab the name of the vector (first column)
+  tokenizer::iterator beg = tokens.begin ();
+  setName (i, *beg);
+  beg++;
+
+  for (; beg != tokens.end (); ++beg) {
+    //  The column of the matrix, or n if this one is not stored
+    unsigned int k = n;
+    if (columns.empty ()) {
+      k = min (j, n);
+    }
+    else if ((j < columns.size ()) && (columns[j] >= 0)) {
+      k = columns[j];
+    }
+
+    if (*beg == "NULL") {
+      if (k < n) {
+        putExpr (i, k, NULL_EXPR);
+        putNull (i, k, true);
+      }
+    }
+    else {
+      try {
+        double value = lexical_cast<double>(*beg);
+        if (k < n) {
+          putExpr (i, k, value);
+          putNull (i, k, false);
+        }
+      }
+      catch (bad_lexical_cast &) {
+        cerr << "\nUnexpected error in reading in microarray data.\nExpecting the keyword \"NULL\" or a double value, but found this instead:  " << *beg << "\nExiting...\n\n";
+        exit (EXIT_FAILURE);
+      }
+    }
+    j++;
+  }
+
+  return j;
+}
+
+//!  Store only some of the columns of the data file
+/*!
+     \param arg The column of the matrix for each column of the data file, or -1 if it is dropped
+
+     Must be called after allocate () and before parseRow ().
+*/
+void EXPRMATRIX::selectColumns (const vector<int> &arg) {
+  columns = arg;
+}
+
+//!  Record the NULL profile of each row and of the whole matrix
+/*!
+     A row with no columns is given the general profile, so that the
+     distance functions still check for an empty set of columns.
+*/
+void EXPRMATRIX::profileNulls () {
+  profile = NULLS_NONE;
+  for (unsigned int i = 0; i < m; i++) {
+    EXPRROW row = getRow (i);
+    unsigned int count = n - countNonNull (row.getNulls (), row.getNulls (), words);
+
+    if (n == 0) {
+      profiles[i] = NULLS_GENERAL;
+    }
+    else if (count == 0) {
+      profiles[i] = NULLS_NONE;
+    }
+    else if (count * NULL_SPARSE_DIVISOR <= n) {
+      profiles[i] = NULLS_SPARSE;
+    }
+    else {
+      profiles[i] = NULLS_GENERAL;
+    }
+    if (profiles[i] > profile) {
+      profile = profiles[i];
+    }
+  }
+}
+
+//!  Record the norm of each row, over its non-null columns
+/*!
+     The cosine and uncentered distances divide by the norms of both
+     rows; they are calculated once here rather than once per pair.
+*/
+void EXPRMATRIX::calculateNorms () {
+  for (unsigned int i = 0; i < m; i++) {
+    norms[i] = getRow (i).getNorm ();
+  }
+}
+
+//!  Reorder the rows of the matrix, along with their attributes
+/*!
+     \param arg The row that moves into each position; row i of the
+            result is row arg[i] of this matrix
+*/
+void EXPRMATRIX::permuteRows (const vector<unsigned int> &arg) {
+  EXPRMATRIX temp;
+
+  temp.allocate (m, n);
+  for (unsigned int i = 0; i < m; i++) {
+    size_t from = arg[i];
+    for (unsigned int j = 0; j < stride; j++) {
+      temp.exprs[static_cast<size_t> (i) * stride + j] = exprs[from * stride + j];
+    }
+    for (unsigned int w = 0; w < words; w++) {
+      temp.nulls[static_cast<size_t> (i) * words + w] = nulls[from * words + w];
+    }
+    temp.profiles[i] = profiles[from];
+    temp.norms[i] = norms[from];
+    temp.names[i] = names[from];
+    temp.colours[i] = colours[from];
+    temp.shapes[i] = shapes[from];
+  }
+  temp.profile = profile;
+  temp.columns = columns;
+
+  swap (temp);
+}
+
+//!  Exchange the contents of this matrix with another one
+void EXPRMATRIX::swap (EXPRMATRIX &other) {
+  std::swap (m, other.m);
+  std::swap (n, other.n);
+  std::swap (stride, other.stride);
+  std::swap (words, other.words);
+  std::swap (exprs, other.exprs);
+  std::swap (nulls, other.nulls);
+  profiles.swap (other.profiles);
+  std::swap (profile, other.profile);
+  norms.swap (other.norms);
+  columns.swap (other.columns);
+  names.swap (other.names);
+  colours.swap (other.colours);
+  shapes.swap (other.shapes);
+}
+
+//!  Put the expression level at row i, column j
+void EXPRMATRIX::putExpr (unsigned int i, unsigned int j, double value) {
+  exprs[static_cast<size_t> (i) * stride + j] = value;
+}
+
+//!  Put the NULL value (true or false) at row i, column j
+void EXPRMATRIX::putNull (unsigned int i, unsigned int j, bool value) {
+  uint64_t bit = static_cast<uint64_t> (1) << (j % NULL_WORD_BITS);
+  uint64_t *word = &nulls[static_cast<size_t> (i) * words + j / NULL_WORD_BITS];
+
+  if (value) {
+    *word |= bit;
+  }
+  else {
+    *word &= ~bit;
+  }
+}
+
+//!  Set the name of experiment i
+void EXPRMATRIX::setName (unsigned int i, string arg) {
+  names[i] = sanitizeSampleName (arg);
+}
+
+//!  Get the name of experiment i
+string EXPRMATRIX::getName (unsigned int i) const {
+  return names[i];
+}
+
+//!  Set the colour of experiment i
+void EXPRMATRIX::setColour (unsigned int i, string arg) {
+  colours[i] = arg;
+}
+
+//!  Get the colour of experiment i
+string EXPRMATRIX::getColour (unsigned int i) const {
+  return colours[i];
+}
+
+//!  Set the shape of experiment i
+void EXPRMATRIX::setShape (unsigned int i, string arg) {
+  shapes[i] = arg;
+}
+
+//!  Get the shape of experiment i
+string EXPRMATRIX::getShape (unsigned int i) const {
+  return shapes[i];
+}
+
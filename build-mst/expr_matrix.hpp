@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file expr_matrix.hpp
+    Header file for EXPRMATRIX class definition
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#ifndef EXPR_MATRIX_HPP
+#define EXPR_MATRIX_HPP
+
+/*!
+     The EXPRMATRIX class holds the microarray data set, with each row
+     (experiment) stored one after another in a single buffer.  Each row
+     is padded with zeroes to a multiple of SIMD_LANES columns, so that
+     every row starts on a 64-byte boundary.  The NULL flags are kept in
+     a second buffer as a bitmap, one bit per column (set = NULL), with
+     the padding flagged as NULL.
+
+     Experiments also have attributes such as a name, colour, and shape,
+     which are kept alongside the expression levels.
+
+     Rows are accessed through lightweight EXPRROW views, which is what
+     the distance functions work on.  The NULL profile of each row is
+     recorded once the matrix has been filled in, so that the distance
+     kernels suited to the rows can be chosen.  The norm of each row is
+     recorded at the same time for the cosine and uncentered distances.
+*/
+class EXPRMATRIX {
+  public:
+    EXPRMATRIX ();
+    ~EXPRMATRIX ();
+
+    void allocate (unsigned int arg1, unsigned int arg2);
+    void selectColumns (const vector<int> &arg);
+    unsigned int parseRow (unsigned int i, string arg);
+    void profileNulls ();
+    void calculateNorms ();
+    void permuteRows (const vector<unsigned int> &arg);
+    void swap (EXPRMATRIX &other);
+
+    //  Mutators
+    void setName (unsigned int i, string arg);
+    void setColour (unsigned int i, string arg);
+    void setShape (unsigned int i, string arg);
+
+    //  Accessors
+    string getName (unsigned int i) const;
+    string getColour (unsigned int i) const;
+    string getShape (unsigned int i) const;
+
+    //!  Get the NULL profile of row i
+    inline NULL_PROFILE getProfile (unsigned int i) const {
+      return profiles[i];
+    }
+
+    //!  Get the NULL profile of the whole matrix (the worst of all rows)
+    inline NULL_PROFILE getProfile () const {
+      return profile;
+    }
+
+    //!  Get the norm of row i over its non-null columns; set by calculateNorms ()
+    inline double getNorm (unsigned int i) const {
+      return norms[i];
+    }
+
+    //!  Get the number of rows
+    inline unsigned int getM () const {
+      return m;
+    }
+
+    //!  Get the number of columns, not including the padding
+    inline unsigned int getN () const {
+      return n;
+    }
+
+    //!  Get the expression level at row i, column j
+    inline double getExpr (unsigned int i, unsigned int j) const {
+      return exprs[static_cast<size_t> (i) * stride + j];
+    }
+
+    //!  Test if the expression level at row i, column j is NULL
+    inline bool isNull (unsigned int i, unsigned int j) const {
+      return ((nulls[static_cast<size_t> (i) * words + j / NULL_WORD_BITS] >> (j % NULL_WORD_BITS)) & 1);
+    }
+
+    void putExpr (unsigned int i, unsigned int j, double value);
+    void putNull (unsigned int i, unsigned int j, bool value);
+
+    //!  Get a view of row i for calculating distances
+    inline EXPRROW getRow (unsigned int i) const {
+      return EXPRROW (exprs + static_cast<size_t> (i) * stride, nulls + static_cast<size_t> (i) * words, n);
+    }
+  private:
+    //  Not copyable, since the matrix owns its buffers
+    EXPRMATRIX (const EXPRMATRIX &src);
+    const EXPRMATRIX &operator= (const EXPRMATRIX &rhs);
+
+    //!  Number of rows (experiments)
+    unsigned int m;
+    //!  Number of columns (probes)
+    unsigned int n;
+    //!  Number of doubles from the start of one row to the next
+    unsigned int stride;
+    //!  Number of words in the NULL bitmap of each row
+    unsigned int words;
+    //!  The expression levels, (m * stride) doubles aligned to 64 bytes
+    double *exprs;
+    //!  The NULL bitmaps, (m * words) words
+    uint64_t *nulls;
+    //!  NULL profile of each row; set by profileNulls ()
+    vector<NULL_PROFILE> profiles;
+    //!  NULL profile of the whole matrix
+    NULL_PROFILE profile;
+    //!  Norm of each row; set by calculateNorms ()
+    vector<double> norms;
+    //!  Column of the matrix for each column of the data file (-1 = dropped); empty if every column is kept
+    vector<int> columns;
+    //!  Name of each experiment
+    vector<string> names;
+    //!  Colour of each experiment
+    vector<string> colours;
+    //!  Shape of each experiment
+    vector<string> shapes;
+};
+
+#endif
+
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file expr_row.hpp
+    Header file for EXPRROW class definition
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#ifndef EXPR_ROW_HPP
+#define EXPR_ROW_HPP
+
+/*!
+     An EXPRROW is a lightweight view of one row of expression levels,
+     either in the expression matrix (EXPRMATRIX) or in a VECT object.
+     It does not own the memory that it points to, so it is cheap to
+     copy and must not outlive the matrix or vector that it came from.
+
+     The expression levels are padded with zeroes to a multiple of
+     SIMD_LANES and the NULL bitmap has one bit per column (set = NULL),
+     with the padding flagged as NULL.
+
+     Since dissimilarity functions operate between two rows, these
+     functions are part of this class but are in their own file.
+*/
+class EXPRROW {
+  public:
+    //!  Constructor that takes the expression levels, the NULL bitmap, and the number of columns
+    inline EXPRROW (const double *arg1, const uint64_t *arg2, unsigned int arg3)
+      : exprs (arg1),
+        nulls (arg2),
+        n (arg3)
+    {
+    }
+
+    //!  Get the expression level at position i
+    inline double getExpr (unsigned int i) const {
+      return exprs[i];
+    }
+
+    //!  Test if the expression level in position i is NULL
+    inline bool isNull (unsigned int i) const {
+      return ((nulls[i / NULL_WORD_BITS] >> (i % NULL_WORD_BITS)) & 1);
+    }
+
+    //!  Get the number of columns, not including the padding
+    inline unsigned int getN () const {
+      return n;
+    }
+
+    //!  Get the number of words in the NULL bitmap
+    inline unsigned int getWords () const {
+      return ((n + NULL_WORD_BITS - 1) / NULL_WORD_BITS);
+    }
+
+    //!  Get the expression levels
+    inline const double *getExprs () const {
+      return exprs;
+    }
+
+    //!  Get the NULL bitmap
+    inline const uint64_t *getNulls () const {
+      return nulls;
+    }
+
+    //  Dissimilarity functions, specialised by the NULL profile of the two rows  [vect_dist.cpp]
+    template <NULL_PROFILE P = NULLS_GENERAL>
+    double simEuc (const EXPRROW &other) const;
+    template <NULL_PROFILE P = NULLS_GENERAL>
+    double simMan (const EXPRROW &other) const;
+    template <NULL_PROFILE P = NULLS_GENERAL>
+    double simPear (const EXPRROW &other) const;
+    double simSpear (const EXPRROW &other) const;
+    double simKendall (const EXPRROW &other) const;
+    template <NULL_PROFILE P = NULLS_GENERAL>
+    double simCosine (const EXPRROW &other, double norm1, double norm2) const;
+    template <NULL_PROFILE P = NULLS_GENERAL>
+    double simUncentered (const EXPRROW &other, double norm1, double norm2) const;
+    double simMutualInfo (const EXPRROW &other) const;
+    double getNorm () const;
+  private:
+    //!  The expression levels
+    const double *exprs;
+    //!  The NULL bitmap
+    const uint64_t *nulls;
+    //!  Number of columns
+    unsigned int n;
+};
+
+#endif
+
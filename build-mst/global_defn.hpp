@@ -65,21 +65,155 @@
 //!  File extension for the file of nodes
 #define NODES_FILE_EXTENSION ".nodes"
 
+//!  The first 8 bytes of a binary distance matrix given with --distance-matrix
+#define DIST_INPUT_MAGIC "HMSTDMAT"
+
+//!  File extension for a cached distance matrix
+#define DIST_CACHE_FILE_EXTENSION ".dist"
+
 //!  The default node colour.
 #define DEFAULT_COLOUR "gray"
 
 //!  The default node shape.
 #define DEFAULT_SHAPE "ellipse"
 
+//!  Cache budget for the expression levels of one tile of the distance matrix (in bytes)
+#define DIST_TILE_BYTES 262144
+
+//!  Maximum number of rows along each side of a tile of the distance matrix
+#define DIST_TILE_MAX_ROWS 128
+
+//!  Number of rows along each side of a tile of the stored distance matrix, as a power of 2
+#define DIST_MATRIX_TILE_BITS 6
+
+//!  Number of rows along each side of a tile of the stored distance matrix
+#define DIST_MATRIX_TILE_ROWS (1 << DIST_MATRIX_TILE_BITS)
+
+//!  Size of the header of a distance matrix file (in bytes); keeps the tiles page-aligned
+#define DIST_FILE_HEADER_BYTES 4096
+
+//!  The first 32-bit integer of a distance matrix file ("HMST")
+#define DIST_FILE_MAGIC 0x54534d48
+
+//!  Number of expression levels processed together by the distance kernels
+#define SIMD_LANES 8
+
+//!  Number of rows along each side of a block of dot products in the blocked distance engine
+#define DOT_BLOCK_ROWS 4
+
+//!  Number of quantized expression levels processed together by the integer kernels of --quantize
+#define QUANT_BLOCK_COLUMNS 16
+
+//!  Number of blocks of 8-bit expression levels summed into 32-bit lanes before they are added up
+#define QUANT8_FLUSH_BLOCKS 65536
+
+//!  Largest number of experiments left in their original order by the bisection of --reorder
+#define REORDER_LEAF_ROWS 32
+
+//!  Number of power iterations used to find the direction each group of experiments is split along by --reorder
+#define REORDER_POWER_ITERATIONS 8
+
+//!  Number of distances sent in each MPI message when the distance matrix is gathered
+#define DIST_MPI_CHUNK 16777216
+
+//!  Number of NULL flags packed into each word of a NULL bitmap
+#define NULL_WORD_BITS 64
+
+//!  A row has sparse NULLs if at most one in this many of its columns is NULL
+#define NULL_SPARSE_DIVISOR 32
+
+//!  Initial value of the 64-bit FNV-1a hash of a microarray file
+#define HASH_FNV_OFFSET 14695981039346656037ULL
+
+//!  Multiplier of the 64-bit FNV-1a hash of a microarray file
+#define HASH_FNV_PRIME 1099511628211ULL
+
 //!  The numerical place-holder for a NULL expression; value does not matter
 #define NULL_EXPR 0
 
+//!  The Kendall rank given to NULL columns (see presortKendall ())
+#define KENDALL_NULL_RANK UINT_MAX
+
+//!  Largest number of shared combined NULL masks grouped for the Spearman correlation (see prepareSpearmanGroups ())
+#define SPEARMAN_MAX_GROUPS 4096
+
+//!  Number of bins each row is discretised into for the mutual information; at most 15
+#define MI_BINS 10
+
+//!  The bin code given to NULL columns for the mutual information; must not be a valid bin
+#define MI_NULL_CODE 15
+
+//!  Number of non-zero entries in each column of the sparse projection for --sketch-dim
+#define SKETCH_NONZEROS 8
+
+//!  Default seed for the sparse projection for --sketch-dim
+#define SKETCH_DEFAULT_SEED 1
+
+//!  Number of extra random directions used to find the --pca components
+#define PCA_OVERSAMPLE 10
+
+//!  Number of power iterations used to find the --pca components
+#define PCA_POWER_ITERATIONS 2
+
+//!  Number of columns handled by a thread at a time in the --pca matrix products
+#define PCA_BLOCK_COLUMNS 64
+
+//!  Maximum number of sweeps of Jacobi rotations for the --pca eigen-decomposition
+#define PCA_JACOBI_SWEEPS 50
+
+//!  Relative tolerance below which a --pca basis vector (or off-diagonal mass) is taken as zero
+#define PCA_RANK_TOLERANCE 1e-12
+
+//!  Seed for the random directions used to find the --pca components
+#define PCA_SEED 1
+
+//!  Number of nearest rows whose values are averaged by --impute knn
+#define IMPUTE_KNN_NEIGHBOURS 10
+
+//!  Number of columns whose joint bin codes are formed at a time for the mutual information
+#define MI_CHUNK_COLUMNS 256
+
+//!  A row without NULLs is stored in compressed sparse form if at most this fraction of its columns is non-zero
+#define SPARSE_MAX_DENSITY 0.05
+
 //!  The distance method used
 enum DIST_METHOD {
   /*! Euclidean distance */ DIST_EUC,
   /*! Manhattan distance */ DIST_MAN,
   /*! Pearson correlation coefficient */ DIST_PEAR,
-  /*! Spearman rank correlation coefficient */ DIST_SPEAR
+  /*! Spearman rank correlation coefficient */ DIST_SPEAR,
+  /*! Kendall rank correlation coefficient (tau-b) */ DIST_KENDALL,
+  /*! Cosine similarity */ DIST_COSINE,
+  /*! Uncentered correlation coefficient */ DIST_UNCENTERED,
+  /*! Mutual information (normalised) */ DIST_MI
+};
+
+//!  How NULLs are filled in before calculating distances
+enum IMPUTE_METHOD {
+  /*! NULLs are kept */ IMPUTE_NONE,
+  /*! Mean of the row */ IMPUTE_ROWMEAN,
+  /*! Mean of the nearest rows */ IMPUTE_KNN
+};
+
+//!  The instruction set used by the distance kernels
+enum SIMD_LEVEL {
+  /*! Portable C++ */ SIMD_SCALAR,
+  /*! SSE2 */ SIMD_SSE2,
+  /*! AVX2 */ SIMD_AVX2,
+  /*! AVX-512 */ SIMD_AVX512
+};
+
+//!  How many NULLs a row (or a group of rows) has, which decides the distance kernels used
+enum NULL_PROFILE {
+  /*! No NULLs */ NULLS_NONE,
+  /*! Few NULLs (see NULL_SPARSE_DIVISOR) */ NULLS_SPARSE,
+  /*! Any number of NULLs */ NULLS_GENERAL
+};
+
+//!  The precision of the distance matrix, the priority queue, and the linkage
+enum PRECISION {
+  /*! Double precision */ PREC_DOUBLE,
+  /*! Single precision */ PREC_FLOAT
 };
 
 //!  The linkage method used
@@ -81,9 +81,10 @@ typedef pair<int, int> EdgePair;
 */
 class GRAPH {
   public:
-    GRAPH (unsigned int M, priority_queue<HEAPNODE, std::vector<HEAPNODE>, greater<HEAPNODE> > pqueue, vector<CLUSTER> clusters);
-    void printEdges (unsigned int id, vector<CLUSTER> clusters, string outpath);
-    void printNodes (unsigned int id, vector<CLUSTER> clusters, string outpath);
+    template <typename T>
+    GRAPH (unsigned int M, HEAPQUEUE<T> pqueue, const vector<CLUSTER> &clusters);
+    void printEdges (unsigned int id, const vector<CLUSTER> &clusters, string outpath);
+    void printNodes (unsigned int id, const vector<CLUSTER> &clusters, const vector<unsigned int> &order, string outpath);
   private:
     //!  The undirected graph represented as an adjacency list
     adjGraph *g;
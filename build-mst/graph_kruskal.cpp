@@ -51,6 +51,7 @@
 #include <vector>
 #include <iostream>
 #include <queue>
+#include <cstdint>  //  uint64_t
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/kruskal_min_spanning_tree.hpp>
@@ -61,7 +62,10 @@ using namespace boost;
 
 #include "global_defn.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
 #include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
 #include "cluster.hpp"
 #include "heapnode.hpp"
 #include "graph.hpp"
@@ -70,14 +74,15 @@ using namespace boost;
 //!  Constructor for GRAPH object with three parameters
 /*!
      \param M Number of experiments (rows) for the current graph (decreases by 1 with each iteration)
-     \param pqueue Priority queue of potential clusters
+     \param pqueue Priority queue of potential clusters (with scores of type T)
      \param clusters Vector of clusters
 
      The constructor builds the graph and then calculates
      the MST using Boost Graph Library's implementation of
      Kruskal's algorithm.
 */
-GRAPH::GRAPH (unsigned int M, priority_queue<HEAPNODE, std::vector<HEAPNODE>, greater<HEAPNODE> > pqueue, vector<CLUSTER> clusters)
+template <typename T>
+GRAPH::GRAPH (unsigned int M, HEAPQUEUE<T> pqueue, const vector<CLUSTER> &clusters)
   : g (),
     edges (),
     weights (),
@@ -86,12 +91,12 @@ GRAPH::GRAPH (unsigned int M, priority_queue<HEAPNODE, std::vector<HEAPNODE>, gr
     spanning_tree_vertices ()
 {
   unsigned int i = 0;
-  HEAPNODE heapnode;
+  HEAPNODE<T> heapnode;
 
   EdgePair *edge_array = NULL;
   double *weights_array = NULL;
 
-  priority_queue<HEAPNODE, std::vector<HEAPNODE>, greater<HEAPNODE> > pqueue2;
+  HEAPQUEUE<T> pqueue2;
 
   //  Number of edges and number of weights is the same
   size_t num_edges = ((M * M) - M) / 2;
@@ -133,7 +138,7 @@ GRAPH::GRAPH (unsigned int M, priority_queue<HEAPNODE, std::vector<HEAPNODE>, gr
 
 
 //!  Print the edges of the MST out to file
-void GRAPH::printEdges (unsigned int id, vector<CLUSTER> clusters, string outpath) {
+void GRAPH::printEdges (unsigned int id, const vector<CLUSTER> &clusters, string outpath) {
   string src;
   string dest;
   string fn = outpath + lexical_cast<std::string>(id) + EDGES_FILE_EXTENSION;
@@ -163,8 +168,15 @@ void GRAPH::printEdges (unsigned int id, vector<CLUSTER> clusters, string outpat
 
 
 //!  Print the nodes of the MST out to file
-void GRAPH::printNodes (unsigned int id, vector<CLUSTER> clusters, string outpath) {
+/*!
+     \param id The number of the merge, used in the filename
+     \param clusters The vector of clusters
+     \param order The cluster of each experiment in the order of the data file (empty if the experiments have not been renumbered)
+     \param outpath The output path
+*/
+void GRAPH::printNodes (unsigned int id, const vector<CLUSTER> &clusters, const vector<unsigned int> &order, string outpath) {
   unsigned int i = 0;
+  unsigned int k = 0;
   string src;
   string dest;
   string fn = outpath + lexical_cast<std::string>(id) + NODES_FILE_EXTENSION;
@@ -176,7 +188,8 @@ void GRAPH::printNodes (unsigned int id, vector<CLUSTER> clusters, string outpat
   }
 
   //  Print out clusters which have no parents
-  for (i = 0; i < clusters.size (); i++) {
+  for (k = 0; k < clusters.size (); k++) {
+    i = (k < order.size ()) ? order[k] : k;
     //  If no parents, then print it out
     if (!clusters[i].haveAncestors ()) {
       fout << clusters[i].getName () << "\t"
@@ -191,3 +204,6 @@ void GRAPH::printNodes (unsigned int id, vector<CLUSTER> clusters, string outpat
   return;
 }
 
+//  Instantiate the constructor for each precision of the distance matrix
+template GRAPH::GRAPH (unsigned int M, HEAPQUEUE<float> pqueue, const vector<CLUSTER> &clusters);
+template GRAPH::GRAPH (unsigned int M, HEAPQUEUE<double> pqueue, const vector<CLUSTER> &clusters);
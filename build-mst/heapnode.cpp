@@ -47,18 +47,21 @@
 /*******************************************************************/
 
 
-using namespace std;
-
+#include <vector>
+#include <queue>  //  priority_queue
 #include <climits>
-#include <cfloat>
+#include <limits>  //  numeric_limits
+
+using namespace std;
 
 #include "heapnode.hpp"
 
 //!  Default HEAPNODE constructor; should never be called (not needed).
-HEAPNODE::HEAPNODE ()
+template <typename T>
+HEAPNODE<T>::HEAPNODE ()
   : left (UINT_MAX),
     right (UINT_MAX),
-    score (DBL_MAX)
+    score (numeric_limits<T>::max ())
 {
 }
 
@@ -68,7 +71,8 @@ HEAPNODE::HEAPNODE ()
      \param arg2 The right child
      \param arg3 The score
 */
-HEAPNODE::HEAPNODE (unsigned int arg1, unsigned int arg2, double arg3)
+template <typename T>
+HEAPNODE<T>::HEAPNODE (unsigned int arg1, unsigned int arg2, T arg3)
   : left (arg1),
     right (arg2),
     score (arg3)
@@ -76,29 +80,35 @@ HEAPNODE::HEAPNODE (unsigned int arg1, unsigned int arg2, double arg3)
 }
 
 //!  Get the left child
-unsigned int HEAPNODE::getLeft () const {
+template <typename T>
+unsigned int HEAPNODE<T>::getLeft () const {
   return left;
 }
 
 //!  Get the right child
-unsigned int HEAPNODE::getRight () const {
+template <typename T>
+unsigned int HEAPNODE<T>::getRight () const {
   return right;
 }
 
 //!  Get the score
-double HEAPNODE::getScore () const {
+template <typename T>
+T HEAPNODE<T>::getScore () const {
   return score;
 }
 
 //!  Overloaded operator for HEAPNODEs (less than)
-bool HEAPNODE::operator< (const HEAPNODE &arg) const {
+template <typename T>
+bool HEAPNODE<T>::operator< (const HEAPNODE<T> &arg) const {
   return (score < arg.score);
 }
 
 //!  Overloaded operator for HEAPNODEs (greater than)
-bool HEAPNODE::operator> (const HEAPNODE &arg) const {
+template <typename T>
+bool HEAPNODE<T>::operator> (const HEAPNODE<T> &arg) const {
   return (score > arg.score);
 }
 
-
-
+//  Instantiate the heap nodes for each precision of the distance matrix
+template class HEAPNODE<float>;
+template class HEAPNODE<double>;
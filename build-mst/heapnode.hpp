@@ -61,26 +61,34 @@
      at the top of the priority queue, and (b) both of its child
      clusters have not already been used to form another cluster earlier
      in the agglomeration process.
+
+     The score is kept with the same precision (T) as the distance matrix;
+     see --precision.
 */
+template <typename T>
 class HEAPNODE {
 	public:
 		HEAPNODE ();
 		//  left, right, and score
-		HEAPNODE (unsigned int arg1, unsigned int arg2, double arg3);
+		HEAPNODE (unsigned int arg1, unsigned int arg2, T arg3);
 		bool operator< (const HEAPNODE &arg) const;
 		bool operator> (const HEAPNODE &arg) const;
 
 		//  Accessors
 		unsigned int getLeft () const;
 		unsigned int getRight () const;
-		double getScore () const;
+		T getScore () const;
 	private:
     //!  The left child.
 		unsigned int left;
     //!  The right child.
 		unsigned int right;
     //!  The score indicating the dissimilarity between the two children.
-		double score;
+		T score;
 };
 
+//!  The priority queue of HEAPNODEs, with the smallest score at the top
+template <typename T>
+using HEAPQUEUE = priority_queue<HEAPNODE<T>, std::vector<HEAPNODE<T> >, greater<HEAPNODE<T> > >;
+
 #endif
@@ -51,23 +51,111 @@
 #include <iostream>  //  cerr
 #include <iomanip>  //  setw
 #include <fstream>  //  ifstream
+#include <string>
+#include <vector>
 #include <queue>  // priority_queue
+#include <algorithm>  //  sort, partial_sort
+#include <utility>  //  pair
+#include <cstdint>  //  uint64_t, uint32_t
+#include <cstring>  //  memcmp, memcpy
 
 #include <boost/tokenizer.hpp>
+#include <boost/lexical_cast.hpp>
 
 using namespace std;
 using namespace boost;
 
 #include "global_defn.hpp"
 #include "check.hpp"
+#include "vect_simd.hpp"
 #include "heapnode.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
 #include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
 #include "cluster.hpp"
 #include "score.hpp"
 #include "build_mst.hpp"
 
 
+//!  Update the running mean and variance of each column with a line of the microarray data file
+/*!
+     \param str The line, including the name of the experiment
+     \param count The number of non-null expression levels of each column so far
+     \param mean The mean of each column so far
+     \param m2 The sum of squared differences from the mean of each column so far
+
+     Welford's method is used, so the columns are accumulated in a single
+     pass without keeping the rows.  NULLs and fields beyond the first row's
+     width are skipped; fields which are not numbers are reported when the
+     line is read again by EXPRMATRIX::parseRow ().
+*/
+static void accumulateVariance (const string &str, vector<unsigned int> &count, vector<double> &mean, vector<double> &m2) {
+  typedef tokenizer<char_separator<char> > tokenizer;
+  char_separator<char> sep ("\t");
+  tokenizer tokens (str, sep);
+  unsigned int j = 0;
+
+  tokenizer::iterator beg = tokens.begin ();
+  if (beg == tokens.end ()) {
+    return;
+  }
+  //  Skip the name of the experiment
+  ++beg;
+  for (; (beg != tokens.end ()) && (j < count.size ()); ++beg, ++j) {
+    if (*beg == "NULL") {
+      continue;
+    }
+    try {
+      double value = lexical_cast<double>(*beg);
+      count[j]++;
+      double delta = value - mean[j];
+      mean[j] += delta / count[j];
+      m2[j] += delta * (value - mean[j]);
+    }
+    catch (bad_lexical_cast &) {
+    }
+  }
+}
+
+
+//!  Choose the columns with the largest variance
+/*!
+     \param count The number of non-null expression levels of each column
+     \param m2 The sum of squared differences from the mean of each column
+     \param k The number of columns to keep
+     \return The column of the matrix for each column of the data file (-1 = dropped)
+
+     Columns with fewer than two expression levels have no variance.  Ties
+     are broken in favour of the earlier column, and the columns that are
+     kept stay in their original order.
+*/
+static vector<int> selectTopVariance (const vector<unsigned int> &count, const vector<double> &m2, unsigned int k) {
+  unsigned int n = count.size ();
+  unsigned int j = 0;
+  vector<pair<double, unsigned int> > order;
+  vector<int> columns (n, -1);
+
+  for (j = 0; j < n; j++) {
+    double variance = (count[j] < 2) ? 0.0 : m2[j] / count[j];
+    order.push_back (make_pair (-variance, j));
+  }
+  partial_sort (order.begin (), order.begin () + k, order.end ());
+
+  vector<unsigned int> kept;
+  for (j = 0; j < k; j++) {
+    kept.push_back (order[j].second);
+  }
+  sort (kept.begin (), kept.end ());
+  for (j = 0; j < k; j++) {
+    columns[kept[j]] = j;
+  }
+
+  return columns;
+}
+
+
 //!  Read the microarray data file in
 /*!
      The data file must be tab-separated with an experiment on each line
@@ -75,14 +163,22 @@ using namespace boost;
      row and column are headers and are basically ignored.  All other
      fields must be either floating point values or the string NULL.
 
-     Each row in the data file translates into a VECT object.
+     The file is read twice.  The first pass counts the rows and the
+     columns of the first row so that the expression matrix can be
+     allocated in one go; the second pass fills in each row.
+
+     With --top-variance K, the first pass also accumulates the variance
+     of each column, and only the K columns with the largest variance are
+     stored by the second pass.
 */
 bool BUILDMST::readMicroarray () {
   unsigned int m = 0;
   unsigned int n = 0;
+  unsigned int count = 0;
   string str;
-  vector<string> tokens;
-  VECT v;
+  vector<unsigned int> counts;
+  vector<double> means;
+  vector<double> m2s;
 
   ifstream ma_fp (getMicroarrayFn ().c_str (), ios::in);
   if (!ma_fp) {
@@ -97,32 +193,282 @@ bool BUILDMST::readMicroarray () {
     return false;
   }
 
+  //  First pass:  count the rows and the columns of the first row
   while (true) {
     getline (ma_fp, str);
     if (ma_fp.eof ()) {
       break;
     }
 
-    //  The integer m is the unique ID (starting from 0) of the vector
-    v = VECT (m, str);
-    if (n == 0) {
-      n = v.getN ();
+    if (m == 0) {
+      typedef tokenizer<char_separator<char> > tokenizer;
+      char_separator<char> sep ("\t");
+      tokenizer tokens (str, sep);
+
+      for (tokenizer::iterator beg = tokens.begin (); beg != tokens.end (); ++beg) {
+        n++;
+      }
+      //  Do not count the name of the experiment
+      if (n > 0) {
+        n--;
+      }
+      if (getTopVariance () != 0) {
+        counts.assign (n, 0);
+        means.assign (n, 0.0);
+        m2s.assign (n, 0.0);
+      }
+    }
+    if (getTopVariance () != 0) {
+      accumulateVariance (str, counts, means, m2s);
     }
-    else if (n != v.getN ()) {
-      cerr << "Error:  Mismatch in vector dimensions -- " << n << " vs " << v.getN () << endl;
+    m++;
+  }
+
+  unsigned int kept = n;
+  if ((getTopVariance () != 0) && (getTopVariance () < n)) {
+    kept = getTopVariance ();
+  }
+  data.allocate (m, kept);
+  if (kept != n) {
+    data.selectColumns (selectTopVariance (counts, m2s, kept));
+  }
+
+  //  Second pass:  rewind, skip the header row, and fill in each row;
+  //    the integer m is the unique ID (starting from 0) of the row
+  ma_fp.clear ();
+  ma_fp.seekg (0, ios::beg);
+  getline (ma_fp, str);
+  m = 0;
+  while (m < data.getM ()) {
+    getline (ma_fp, str);
+
+    count = data.parseRow (m, str);
+    if (n != count) {
+      cerr << "Error:  Mismatch in vector dimensions -- " << n << " vs " << count << endl;
       return false;
     }
-    data.push_back (v);
     m++;
   }
   ma_fp.close ();
+  data.profileNulls ();
+  data.calculateNorms ();
 
   //  Set the number of rows in the data set; same as number of nodes in the first MST
   setM (m);
-  setN (n);
+  setN (kept);
+
+  if (getVerbose ()) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tMicroarray dimensions:" << getM () << " by " << n << endl;
+    if (kept != n) {
+      cerr << left << setw (VERBOSE_WIDTH) << "==\tColumns kept by variance:" << kept << endl;
+    }
+
+    unsigned int sparse = 0;
+    unsigned int general = 0;
+    for (m = 0; m < getM (); m++) {
+      if (data.getProfile (m) == NULLS_SPARSE) {
+        sparse++;
+      }
+      else if (data.getProfile (m) == NULLS_GENERAL) {
+        general++;
+      }
+    }
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tRows with NULLs:" << sparse + general << " (" << sparse << " with few NULLs)" << endl;
+  }
+
+  return true;
+}
+
+
+//!  Read a precomputed distance matrix in, instead of the microarray data file
+/*!
+     The file is either tab-separated text (see readDistancesText ()) or
+     binary (see readDistancesBinary ()); binary files start with
+     DIST_INPUT_MAGIC.  The names of the experiments are taken from the
+     header of the file.  The distances are stored in the distance matrix
+     with the chosen precision, so initializeDistances () only has to add
+     them into the priority queue.
+*/
+bool BUILDMST::readDistanceMatrix () {
+  char magic[sizeof (DIST_INPUT_MAGIC) - 1];
+  bool result = false;
+
+  ifstream dm_fp (getDistanceMatrixFn ().c_str (), ios::in | ios::binary);
+  if (!dm_fp) {
+    cerr << "==\tError:  Input file " << getDistanceMatrixFn () << " could not be opened!" << endl;
+    return false;
+  }
+
+  dm_fp.read (magic, sizeof (magic));
+  bool binary = (dm_fp.gcount () == static_cast<streamsize> (sizeof (magic))) && (memcmp (magic, DIST_INPUT_MAGIC, sizeof (magic)) == 0);
+  dm_fp.clear ();
+  dm_fp.seekg (0, ios::beg);
+
+  if (binary) {
+    result = readDistancesBinary (dm_fp);
+  }
+  else {
+    result = readDistancesText (dm_fp);
+  }
+  dm_fp.close ();
+
+  if (!result) {
+    return false;
+  }
 
   if (getVerbose ()) {
-    cerr << left << setw (VERBOSE_WIDTH) << "==\tMicroarray dimensions:" << getM () << " by " << getN () << endl;
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tDistance matrix dimensions:" << getM () << " by " << getM () << (binary ? " (binary)" : " (text)") << endl;
+  }
+
+  return true;
+}
+
+
+//!  Read a precomputed distance matrix in from tab-separated text
+/*!
+     \param fp The file, positioned at its start
+     \return Whether or not the file was read in successfully
+
+     The first row holds the names of the experiments after a label that
+     is ignored.  Each of the following rows holds the name of an
+     experiment and its distance to every experiment, in the same order
+     as the first row.  Only the distances above the diagonal are used.
+*/
+bool BUILDMST::readDistancesText (istream &fp) {
+  unsigned int m = 0;
+  unsigned int i = 0;
+  unsigned int j = 0;
+  string str;
+  typedef tokenizer<char_separator<char> > tokenizer;
+  char_separator<char> sep ("\t");
+
+  getline (fp, str);
+  if (fp.fail ()) {
+    cerr << "Error:  Failed opening the distance matrix for reading!" << endl;
+    return false;
+  }
+
+  vector<string> names;
+  tokenizer header (str, sep);
+  for (tokenizer::iterator beg = header.begin (); beg != header.end (); ++beg) {
+    names.push_back (*beg);
+  }
+  //  Do not count the label of the header row
+  if (names.size () < 2) {
+    cerr << "Error:  The distance matrix has no experiments!" << endl;
+    return false;
+  }
+  m = names.size () - 1;
+
+  data.allocate (m, 0);
+  for (i = 0; i < m; i++) {
+    data.setName (i, names[i + 1]);
+  }
+  setM (m);
+  setN (0);
+  openDistances ();
+
+  for (i = 0; i < m; i++) {
+    getline (fp, str);
+    if (fp.fail ()) {
+      cerr << "Error:  The distance matrix has " << i << " rows instead of " << m << "!" << endl;
+      return false;
+    }
+
+    vector<string> values;
+    tokenizer tokens (str, sep);
+    for (tokenizer::iterator beg = tokens.begin (); beg != tokens.end (); ++beg) {
+      values.push_back (*beg);
+    }
+    if (values.size () != m + 1) {
+      cerr << "Error:  Mismatch in distance matrix dimensions on row " << i + 1 << " -- " << m << " vs " << values.size () - 1 << endl;
+      return false;
+    }
+
+    for (j = i + 1; j < m; j++) {
+      try {
+        storeDistance (i, j, lexical_cast<double> (values[j + 1]));
+      }
+      catch (bad_lexical_cast &) {
+        cerr << "Error:  Distance between " << names[i + 1] << " and " << names[j + 1] << " is not a number:  " << values[j + 1] << endl;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+
+//!  Read a precomputed distance matrix in from a binary file
+/*!
+     \param fp The file, positioned at its start
+     \return Whether or not the file was read in successfully
+
+     The file holds, in the byte order of the machine:
+       - DIST_INPUT_MAGIC (8 bytes)
+       - the number of experiments M, as a 32-bit integer
+       - the size of each distance (4 for float or 8 for double), as a 32-bit integer
+       - the names of the M experiments, each terminated by a 0 byte
+       - the distances above the diagonal, row by row:  (0, 1), (0, 2), ...,
+         (0, M - 1), (1, 2), ..., (M - 2, M - 1)
+*/
+bool BUILDMST::readDistancesBinary (istream &fp) {
+  char magic[sizeof (DIST_INPUT_MAGIC) - 1];
+  uint32_t fields[2] = {0, 0};
+  unsigned int m = 0;
+  unsigned int i = 0;
+  unsigned int j = 0;
+  string str;
+
+  fp.read (magic, sizeof (magic));
+  fp.read (reinterpret_cast<char*> (fields), sizeof (fields));
+  if (!fp) {
+    cerr << "Error:  The header of the distance matrix is incomplete!" << endl;
+    return false;
+  }
+  m = fields[0];
+  size_t bytes = fields[1];
+  if ((bytes != sizeof (float)) && (bytes != sizeof (double))) {
+    cerr << "Error:  Distances of " << bytes << " bytes are not supported (only 4 or 8)!" << endl;
+    return false;
+  }
+
+  data.allocate (m, 0);
+  for (i = 0; i < m; i++) {
+    getline (fp, str, '\0');
+    if (!fp) {
+      cerr << "Error:  The distance matrix has " << i << " names instead of " << m << "!" << endl;
+      return false;
+    }
+    data.setName (i, str);
+  }
+  setM (m);
+  setN (0);
+  openDistances ();
+
+  vector<char> buffer (m * bytes);
+  for (i = 0; i + 1 < m; i++) {
+    size_t count = (m - 1 - i) * bytes;
+    fp.read (&buffer[0], count);
+    if (static_cast<size_t> (fp.gcount ()) != count) {
+      cerr << "Error:  The distance matrix ends before row " << i + 1 << " is complete!" << endl;
+      return false;
+    }
+
+    for (j = i + 1; j < m; j++) {
+      const char *ptr = &buffer[(j - i - 1) * bytes];
+      if (bytes == sizeof (float)) {
+        float value;
+        memcpy (&value, ptr, sizeof (value));
+        storeDistance (i, j, value);
+      }
+      else {
+        double value;
+        memcpy (&value, ptr, sizeof (value));
+        storeDistance (i, j, value);
+      }
+    }
   }
 
   return true;
@@ -177,13 +523,13 @@ bool BUILDMST::readAttr () {
     }
     else {
       //  Only set the information if the names match
-      if (data[i].getName () == sanitizeSampleName (values[0])) {
-        data[i].setName (values[0]);
-        data[i].setColour (values[1]);
-        data[i].setShape (values[2]);
+      if (data.getName (i) == sanitizeSampleName (values[0])) {
+        data.setName (i, values[0]);
+        data.setColour (i, values[1]);
+        data.setShape (i, values[2]);
       }
       else {
-        cerr << "Error:  Microarray and attribute file names do not match:  " << data[i].getName () << " vs " << sanitizeSampleName (values[0]) << endl;
+        cerr << "Error:  Microarray and attribute file names do not match:  " << data.getName (i) << " vs " << sanitizeSampleName (values[0]) << endl;
         cerr << "Most likely the order of the sample names in the two files are different." << endl;
       }
     }
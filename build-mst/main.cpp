@@ -52,14 +52,27 @@
 #include <vector>
 #include <queue>  //  priority_queue
 
+#include <cstdint>  //  uint64_t
 #include <cstdlib>
 
 using namespace std;
 
+#include "BuildMSTConfig.hpp"
+
+#if HAVE_MPI
+#include <boost/mpi/environment.hpp>
+#include <boost/mpi/communicator.hpp>
+using boost::mpi::environment;
+using boost::mpi::communicator;
+#endif
+
 #include "global_defn.hpp"
 #include "heapnode.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
 #include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
 #include "cluster.hpp"
 #include "score.hpp"
 #include "build_mst.hpp"
@@ -69,11 +82,23 @@ using namespace std;
      Create a BUILDMST object and then uses it to read in the parameters from
      the file and the command line.  If all the settings check out, then run
      the main program.
+
+     If MPI is in use, every process reads the options and the data; the
+     distance matrix is split between them (see distributeColumns ()) and
+     the rest is done by the primary process.
 */
 int main (int argc, char *argv[]) {
+#if HAVE_MPI
+  environment env (argc, argv);
+  communicator world;
+#endif
   BUILDMST hamster;
 
   hamster.initSettings ();
+#if HAVE_MPI
+  hamster.setRank (world.rank ());
+  hamster.setWorldSize (world.size ());
+#endif
 
   //  Read the configuration file and then the command line parameters
   if (!hamster.processOptions (argc, argv)) {
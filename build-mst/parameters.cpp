@@ -53,6 +53,7 @@
 #include <string>
 #include <vector>
 #include <queue>  //  priority_queue
+#include <cstdint>  //  uint64_t
 
 #include <boost/program_options.hpp>
 
@@ -61,10 +62,19 @@ using namespace boost;
 namespace po = boost::program_options;
 
 #include "BuildMSTConfig.hpp"
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
 #include "global_defn.hpp"
+#include "vect_simd.hpp"
 #include "heapnode.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
 #include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
 #include "cluster.hpp"
 #include "score.hpp"
 #include "build_mst.hpp"
@@ -73,10 +83,14 @@ namespace po = boost::program_options;
 //!  Initialize settings to provide default values
 /*!
      We initialize values which are not initialized by the processOptions function.
+     This process is taken to be the only one; main () sets the rank and
+     the number of processes if MPI is in use.
 */
 void BUILDMST::initSettings () {
   setM (0);
   setN (0);
+  setRank (0);
+  setWorldSize (1);
 
   return;
 }
@@ -103,6 +117,7 @@ bool BUILDMST::processOptions (int argc, char *argv[]) {
   //  Initialize default values
   setDebug (false);
   setVerbose (false);
+  setBlocked (false);
   setDistance (DIST_EUC);
   setLinkage (LINK_SINGLE);
   setScoreMethod (SCORE_GAPS);
@@ -128,11 +143,28 @@ bool BUILDMST::processOptions (int argc, char *argv[]) {
       ("debug", "Turn debugging on")
       ("verbose", "Turn verbose output on")
       ("path", po::value<string>() -> default_value ("./"), "Input/output path")
-      ("distance", po::value<string>(), "Distance method [ euclidean* | manhattan | pearson | spearman ]")
+      ("threads", po::value<unsigned int>() -> default_value (1), "Number of threads for calculating distances (0 = all processors)")
+      ("simd", po::value<string>(), "Instruction set for distances [ auto* | avx512 | avx2 | sse2 | none ]")
+      ("blocked", "Use the blocked engine for distances between rows without NULLs (not Manhattan)")
+      ("precision", po::value<string>(), "Precision of the distance matrix [ double* | float ]")
+      ("matrix-file", po::value<string>(), "Keep the distance matrix in this memory-mapped file instead of in memory (overwritten)")
+      ("cache-dir", po::value<string>(), "Reuse distance matrices cached in this directory; overrides --matrix-file")
+      ("extend", po::value<string>(), "Cache entry of an earlier version of the microarray file with fewer rows; only new pairs are calculated")
+      ("distance", po::value<string>(), "Distance method [ euclidean* | manhattan | pearson | spearman | kendall | cosine | uncentered | mi ]")
       ("linkage", po::value<string>(), "Linkage method [ single* | average | complete | centroid ]")
       ("scoring", po::value<string>(), "Scoring method [ gaps* | anova | nassoc | nassoc_orig ]")
-      ("centroid", po::value<string>(), "Centroid distance method [ euclidean* | manhattan | pearson | spearman ]")
+      ("centroid", po::value<string>(), "Centroid distance method [ euclidean* | manhattan | pearson | spearman | kendall | cosine | uncentered | mi ]")
       ("attr", po::value<string>(), "Attribute filename")
+      ("distance-matrix", po::value<string>(), "Precomputed distance matrix (TSV or binary) to read instead of a microarray file")
+      ("sketch-dim", po::value<unsigned int>(), "Project each row into this many dimensions before calculating distances (euclidean, cosine and uncentered only)")
+      ("sketch-seed", po::value<unsigned int>(), "Seed for the projection of --sketch-dim")
+      ("sketch-check", "Compare the distance of each merge of two experiments against the exact one (with --sketch-dim)")
+      ("impute", po::value<string>(), "Fill in NULLs before calculating distances [ rowmean | knn ]")
+      ("stream-columns", po::value<unsigned int>(), "Stream the microarray file this many columns at a time instead of reading it in whole (euclidean, manhattan, pearson, cosine or uncentered)")
+      ("top-variance", po::value<unsigned int>(), "Keep only this many columns (probes) with the largest variance while reading the microarray file")
+      ("pca", po::value<unsigned int>(), "Reduce the experiments to their scores on this many principal components before calculating distances")
+      ("quantize", po::value<unsigned int>(), "Screen distances with rows quantized to this many bits [ 8 | 16 ]; merges are recalculated exactly (euclidean, pearson, cosine and uncentered only)")
+      ("reorder", "Renumber the experiments so that similar ones are close together in the distance matrix; the output uses the original order")
       ;
 
     //  Hidden options that are allowed on both the command line and the configuration
@@ -191,6 +223,51 @@ bool BUILDMST::processOptions (int argc, char *argv[]) {
       setPath (vm["path"].as<string>());
     }
 
+    if (vm.count ("threads")) {
+      setThreads (vm["threads"].as<unsigned int>());
+    }
+
+    if (vm.count ("blocked")) {
+      setBlocked (true);
+    }
+
+    if (vm.count ("simd")) {
+      string simd_tmp = vm["simd"].as<string>();
+      if (simd_tmp == "auto") {
+        setSIMDLevel (detectSIMDLevel ());
+      }
+      else if (simd_tmp == "avx512") {
+        setSIMDLevel (SIMD_AVX512);
+      }
+      else if (simd_tmp == "avx2") {
+        setSIMDLevel (SIMD_AVX2);
+      }
+      else if (simd_tmp == "sse2") {
+        setSIMDLevel (SIMD_SSE2);
+      }
+      else if (simd_tmp == "none") {
+        setSIMDLevel (SIMD_SCALAR);
+      }
+      else {
+        cerr << "The argument to --simd was not recognized:  " << simd_tmp << endl;
+        return false;
+      }
+    }
+
+    if (vm.count ("precision")) {
+      string precision_tmp = vm["precision"].as<string>();
+      if (precision_tmp == "double") {
+        setPrecision (PREC_DOUBLE);
+      }
+      else if (precision_tmp == "float") {
+        setPrecision (PREC_FLOAT);
+      }
+      else {
+        cerr << "The argument to --precision was not recognized:  " << precision_tmp << endl;
+        return false;
+      }
+    }
+
     if (vm.count ("distance")) {
       string distance_tmp = vm["distance"].as<string>();
       if (distance_tmp == "euclidean") {
@@ -205,6 +282,18 @@ bool BUILDMST::processOptions (int argc, char *argv[]) {
       else if (distance_tmp == "spearman") {
         setDistance (DIST_SPEAR);
       }
+      else if (distance_tmp == "kendall") {
+        setDistance (DIST_KENDALL);
+      }
+      else if (distance_tmp == "cosine") {
+        setDistance (DIST_COSINE);
+      }
+      else if (distance_tmp == "uncentered") {
+        setDistance (DIST_UNCENTERED);
+      }
+      else if (distance_tmp == "mi") {
+        setDistance (DIST_MI);
+      }
       else {
         cerr << "The argument to --distance was not recognized:  " << distance_tmp << endl;
         return false;
@@ -265,6 +354,18 @@ bool BUILDMST::processOptions (int argc, char *argv[]) {
       else if (centroid_tmp == "spearman") {
         setCentroid (DIST_SPEAR);
       }
+      else if (centroid_tmp == "kendall") {
+        setCentroid (DIST_KENDALL);
+      }
+      else if (centroid_tmp == "cosine") {
+        setCentroid (DIST_COSINE);
+      }
+      else if (centroid_tmp == "uncentered") {
+        setCentroid (DIST_UNCENTERED);
+      }
+      else if (centroid_tmp == "mi") {
+        setCentroid (DIST_MI);
+      }
       else {
         cerr << "The argument to --centroid was not recognized:  " << centroid_tmp << endl;
         return false;
@@ -278,6 +379,68 @@ bool BUILDMST::processOptions (int argc, char *argv[]) {
     if (vm.count ("microarray")) {
       setMicroarrayFn (vm["microarray"].as<string>());
     }
+
+    if (vm.count ("distance-matrix")) {
+      setDistanceMatrixFn (vm["distance-matrix"].as<string>());
+    }
+
+    if (vm.count ("matrix-file")) {
+      setMatrixFn (vm["matrix-file"].as<string>());
+    }
+
+    if (vm.count ("cache-dir")) {
+      setCacheDir (vm["cache-dir"].as<string>());
+    }
+
+    if (vm.count ("extend")) {
+      setExtendFn (vm["extend"].as<string>());
+    }
+
+    if (vm.count ("sketch-dim")) {
+      setSketchDim (vm["sketch-dim"].as<unsigned int>());
+    }
+
+    if (vm.count ("sketch-seed")) {
+      setSketchSeed (vm["sketch-seed"].as<unsigned int>());
+    }
+
+    if (vm.count ("sketch-check")) {
+      setSketchCheck (true);
+    }
+
+    if (vm.count ("impute")) {
+      string impute_tmp = vm["impute"].as<string>();
+      if (impute_tmp == "rowmean") {
+        setImpute (IMPUTE_ROWMEAN);
+      }
+      else if (impute_tmp == "knn") {
+        setImpute (IMPUTE_KNN);
+      }
+      else {
+        cerr << "The argument to --impute was not recognized:  " << impute_tmp << endl;
+        return false;
+      }
+    }
+
+    if (vm.count ("stream-columns")) {
+      setStreamColumns (vm["stream-columns"].as<unsigned int>());
+    }
+
+    if (vm.count ("top-variance")) {
+      setTopVariance (vm["top-variance"].as<unsigned int>());
+    }
+
+    if (vm.count ("pca")) {
+      setPcaDim (vm["pca"].as<unsigned int>());
+    }
+
+    if (vm.count ("quantize")) {
+      setQuantize (vm["quantize"].as<unsigned int>());
+    }
+
+    if (vm.count ("reorder")) {
+      setReorder (true);
+    }
   }
   catch(std::exception& e) {
     cout << e.what() << "\n";
@@ -298,11 +461,112 @@ bool BUILDMST::checkSettings () {
   string str;
   unsigned int len;
 
-  if (getMicroarrayFn ().empty ()) {
+  //  Only the primary process reports its progress
+  if (getRank () != 0) {
+    setVerbose (false);
+    setDebug (false);
+  }
+
+  if (getMicroarrayFn ().empty () && getDistanceMatrixFn ().empty ()) {
     cerr << "==\tError:  Microarray filename required!" << endl;
     return false;
   }
 
+  if (!getDistanceMatrixFn ().empty ()) {
+    //  The expression levels are needed to form centroids
+    if (getLinkage () == LINK_CENTROID) {
+      cerr << "==\tError:  Centroid linkage cannot be used with --distance-matrix!" << endl;
+      return false;
+    }
+    //  Nothing is calculated, so there is nothing to cache
+    if (!getCacheDir ().empty ()) {
+      cerr << "==\tWarning:  --cache-dir is ignored with --distance-matrix." << endl;
+      setCacheDir ("");
+    }
+    //  ... or to project
+    if (getSketchDim () != 0) {
+      cerr << "==\tWarning:  --sketch-dim is ignored with --distance-matrix." << endl;
+      setSketchDim (0);
+    }
+    if (getPcaDim () != 0) {
+      cerr << "==\tWarning:  --pca is ignored with --distance-matrix." << endl;
+      setPcaDim (0);
+    }
+    if (getTopVariance () != 0) {
+      cerr << "==\tWarning:  --top-variance is ignored with --distance-matrix." << endl;
+      setTopVariance (0);
+    }
+    if (getImpute () != IMPUTE_NONE) {
+      cerr << "==\tWarning:  --impute is ignored with --distance-matrix." << endl;
+      setImpute (IMPUTE_NONE);
+    }
+    if (getStreamColumns () != 0) {
+      cerr << "==\tWarning:  --stream-columns is ignored with --distance-matrix." << endl;
+      setStreamColumns (0);
+    }
+    if (getQuantize () != 0) {
+      cerr << "==\tWarning:  --quantize is ignored with --distance-matrix." << endl;
+      setQuantize (0);
+    }
+    if (getReorder ()) {
+      cerr << "==\tWarning:  --reorder is ignored with --distance-matrix." << endl;
+      setReorder (false);
+    }
+  }
+
+  if (getStreamColumns () != 0) {
+    //  Only the sums over pairs of rows are kept
+    if ((getDistance () != DIST_EUC) && (getDistance () != DIST_MAN) && (getDistance () != DIST_PEAR) &&
+        (getDistance () != DIST_COSINE) && (getDistance () != DIST_UNCENTERED)) {
+      cerr << "==\tError:  --stream-columns requires the euclidean, manhattan, pearson, cosine or uncentered distance!" << endl;
+      return false;
+    }
+    if (getLinkage () == LINK_CENTROID) {
+      cerr << "==\tError:  Centroid linkage cannot be used with --stream-columns!" << endl;
+      return false;
+    }
+    //  The rows are never held in memory, so none of these apply
+    if (!getCacheDir ().empty ()) {
+      cerr << "==\tWarning:  --cache-dir is ignored with --stream-columns." << endl;
+      setCacheDir ("");
+    }
+    if ((getSketchDim () != 0) || (getPcaDim () != 0) || (getTopVariance () != 0) || (getImpute () != IMPUTE_NONE) || getBlocked () || (getQuantize () != 0) || getReorder ()) {
+      cerr << "==\tWarning:  --sketch-dim, --pca, --top-variance, --impute, --blocked, --quantize and --reorder are ignored with --stream-columns." << endl;
+      setSketchDim (0);
+      setPcaDim (0);
+      setTopVariance (0);
+      setImpute (IMPUTE_NONE);
+      setBlocked (false);
+      setQuantize (0);
+      setReorder (false);
+    }
+  }
+
+  if (getQuantize () != 0) {
+    if ((getQuantize () != 8) && (getQuantize () != 16)) {
+      cerr << "==\tError:  --quantize must be 8 or 16!" << endl;
+      return false;
+    }
+    //  Only distances that can be written in terms of dot products can be bounded
+    if ((getDistance () != DIST_EUC) && (getDistance () != DIST_PEAR) && (getDistance () != DIST_COSINE) && (getDistance () != DIST_UNCENTERED)) {
+      cerr << "==\tWarning:  --quantize requires the euclidean, pearson, cosine or uncentered distance; it is ignored." << endl;
+      setQuantize (0);
+    }
+  }
+
+  if ((getSketchDim () != 0) && (getPcaDim () != 0)) {
+    cerr << "==\tError:  --sketch-dim and --pca cannot be used together!" << endl;
+    return false;
+  }
+
+  if (getSketchDim () != 0) {
+    //  Random projections only preserve distances and angles between rows
+    if ((getDistance () != DIST_EUC) && (getDistance () != DIST_COSINE) && (getDistance () != DIST_UNCENTERED)) {
+      cerr << "==\tError:  --sketch-dim requires the euclidean, cosine or uncentered distance!" << endl;
+      return false;
+    }
+  }
+
   if (!getPath ().empty ()) {
     //  Ensure the path is terminated by a "/"
     str = getPath ();
@@ -312,6 +576,31 @@ bool BUILDMST::checkSettings () {
     }
   }
 
+  if ((!getExtendFn ().empty ()) && getCacheDir ().empty ()) {
+    cerr << "==\tError:  --extend requires --cache-dir!" << endl;
+    return false;
+  }
+
+  if (!getCacheDir ().empty ()) {
+    //  Ensure the cache directory is terminated by a "/"
+    str = getCacheDir ();
+    len = str.length () - 1;
+    if (str.at (len) != '/') {
+      setCacheDir (getCacheDir () + "/");
+    }
+  }
+
+#if HAVE_OPENMP
+  if (getThreads () == 0) {
+    setThreads (omp_get_num_procs ());
+  }
+#else
+  if (getThreads () != 1) {
+    cerr << "==\tWarning:  Compiled without OpenMP; distances will be calculated with one thread." << endl;
+  }
+  setThreads (1);
+#endif
+
   if (getVerbose ()) {
     cerr << left << setw (VERBOSE_WIDTH) << "==\tDistance method:";
     switch (getDistance ()) {
@@ -323,6 +612,14 @@ bool BUILDMST::checkSettings () {
         break;
       case DIST_SPEAR  : cerr << "Spearman correlation";
         break;
+      case DIST_KENDALL: cerr << "Kendall correlation";
+        break;
+      case DIST_COSINE : cerr << "Cosine similarity";
+        break;
+      case DIST_UNCENTERED : cerr << "Uncentered correlation";
+        break;
+      case DIST_MI : cerr << "Mutual information";
+        break;
     }
     cerr << endl;
 
@@ -347,6 +644,14 @@ bool BUILDMST::checkSettings () {
             break;
           case DIST_SPEAR  : cerr << "Spearman correlation";
             break;
+          case DIST_KENDALL: cerr << "Kendall correlation";
+            break;
+          case DIST_COSINE : cerr << "Cosine similarity";
+            break;
+          case DIST_UNCENTERED : cerr << "Uncentered correlation";
+            break;
+          case DIST_MI : cerr << "Mutual information";
+            break;
         }
         break;
     }
@@ -365,7 +670,36 @@ bool BUILDMST::checkSettings () {
     }
     cerr << endl;
 
-    cerr << left << setw (VERBOSE_WIDTH) << "==\tMicroarray filename:" << getMicroarrayFn () << endl;
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tThreads:" << getThreads () << endl;
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tMPI in use:";
+#if HAVE_MPI
+    cerr << "Yes (" << getWorldSize () << " processes)" << endl;
+#else
+    cerr << "No" << endl;
+#endif
+
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tInstruction set:";
+    switch (getSIMDLevel ()) {
+      case SIMD_AVX512 : cerr << "AVX-512";
+        break;
+      case SIMD_AVX2   : cerr << "AVX2";
+        break;
+      case SIMD_SSE2   : cerr << "SSE2";
+        break;
+      case SIMD_SCALAR : cerr << "None";
+        break;
+    }
+    cerr << endl;
+
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tBlocked engine:" << (getBlocked () ? "Yes" : "No") << endl;
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tPrecision:" << ((getPrecision () == PREC_FLOAT) ? "Float" : "Double") << endl;
+
+    if (getDistanceMatrixFn ().empty ()) {
+      cerr << left << setw (VERBOSE_WIDTH) << "==\tMicroarray filename:" << getMicroarrayFn () << endl;
+    }
+    else {
+      cerr << left << setw (VERBOSE_WIDTH) << "==\tPrecomputed distance matrix:" << getDistanceMatrixFn () << endl;
+    }
     cerr << left << setw (VERBOSE_WIDTH) << "==\tAttribute filename:";
     if (getAttrFn ().empty ()) {
       cerr << "N/A" << endl;
@@ -373,6 +707,68 @@ bool BUILDMST::checkSettings () {
     else {
       cerr << getAttrFn () << endl;
     }
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tDistance matrix filename:";
+    if (getMatrixFn ().empty ()) {
+      cerr << "N/A (in memory)" << endl;
+    }
+    else {
+      cerr << getMatrixFn () << endl;
+    }
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tDistance matrix cache:";
+    if (getCacheDir ().empty ()) {
+      cerr << "N/A" << endl;
+    }
+    else {
+      cerr << getCacheDir () << endl;
+    }
+    if (!getExtendFn ().empty ()) {
+      cerr << left << setw (VERBOSE_WIDTH) << "==\tExtending cache entry:" << getExtendFn () << endl;
+    }
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tSketch dimensions:";
+    if (getSketchDim () == 0) {
+      cerr << "N/A" << endl;
+    }
+    else {
+      cerr << getSketchDim () << " (seed " << getSketchSeed () << (getSketchCheck () ? ", checked" : "") << ")" << endl;
+    }
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tStreamed columns:";
+    if (getStreamColumns () == 0) {
+      cerr << "N/A" << endl;
+    }
+    else {
+      cerr << getStreamColumns () << " at a time" << endl;
+    }
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tImputation:";
+    switch (getImpute ()) {
+      case IMPUTE_NONE : cerr << "N/A" << endl;
+        break;
+      case IMPUTE_ROWMEAN : cerr << "Row mean" << endl;
+        break;
+      case IMPUTE_KNN : cerr << IMPUTE_KNN_NEIGHBOURS << " nearest rows" << endl;
+        break;
+    }
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tColumns kept by variance:";
+    if (getTopVariance () == 0) {
+      cerr << "All" << endl;
+    }
+    else {
+      cerr << getTopVariance () << endl;
+    }
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tPrincipal components:";
+    if (getPcaDim () == 0) {
+      cerr << "N/A" << endl;
+    }
+    else {
+      cerr << getPcaDim () << endl;
+    }
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tQuantized screening:";
+    if (getQuantize () == 0) {
+      cerr << "N/A" << endl;
+    }
+    else {
+      cerr << getQuantize () << " bits" << endl;
+    }
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tReorder experiments:" << (getReorder () ? "Yes" : "No") << endl;
 
     cerr << left << setw (VERBOSE_WIDTH) << "==\tOutput path:";
     if (getPath ().empty ()) {
@@ -51,6 +51,7 @@
 #include <string>
 #include <vector>
 #include <queue>  //  priority_queue
+#include <cstdint>  //  uint64_t
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/adjacency_matrix.hpp>
@@ -60,7 +61,10 @@ using namespace std;
 #include "global_defn.hpp"
 #include "heapnode.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
 #include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
 #include "cluster.hpp"
 #include "graph.hpp"
 #include "score.hpp"
@@ -71,10 +75,45 @@ void BUILDMST::run () {
   //  Read the data in; return if either read produces an error
   //  The attribute file is *optional*, so not having one is not
   //    an error
-  if (!readMicroarray () || !readAttr ()) {
+  //  A precomputed distance matrix replaces the microarray data file
+  //  A streamed microarray file gives the distances straight away
+  //  Other MPI processes have nothing to calculate with a precomputed or
+  //    streamed distance matrix
+  if ((getRank () != 0) && (!getDistanceMatrixFn ().empty () || (getStreamColumns () != 0))) {
+    return;
+  }
+  bool read = false;
+  if (!getDistanceMatrixFn ().empty ()) {
+    read = readDistanceMatrix ();
+  }
+  else if (getStreamColumns () != 0) {
+    read = streamMicroarray ();
+  }
+  else {
+    read = readMicroarray ();
+  }
+  if (!read || !readAttr ()) {
     return;
   }
 
+  //  Fill in the NULLs, if requested
+  if (getImpute () != IMPUTE_NONE) {
+    imputeData ();
+  }
+
+  //  Project the rows into fewer dimensions, if requested
+  if (getSketchDim () != 0) {
+    sketchData ();
+  }
+  else if (getPcaDim () != 0) {
+    reduceData ();
+  }
+
+  //  Renumber the experiments so that similar ones are close together, if requested
+  if (getReorder ()) {
+    reorderData ();
+  }
+
   //  Each experiment is a cluster, so we can initialize it now
   initializeClusters ();
 
@@ -82,17 +121,58 @@ void BUILDMST::run () {
   //    (at this initial stage)
   initializeDistances ();
 
+  //  Other MPI processes only help to calculate the distances
+  if (getRank () != 0) {
+    return;
+  }
+
+  if (getPrecision () == PREC_FLOAT) {
+    agglomerate<float> ();
+  }
+  else {
+    agglomerate<double> ();
+  }
+
+  if (getVerbose ()) {
+    reportSketch ();
+    reportQuantized ();
+  }
+
+  //  Normalize the scores to 0..100
+  normalizeScores ();
+
+  printScores (getPath ());
+
+  return;
+}
+
+
+//!  Merge the clusters one at a time, printing the MST before each merge
+/*!
+     T is the precision of the distance matrix and the priority queue.
+*/
+template <typename T>
+void BUILDMST::agglomerate () {
+  HEAPQUEUE<T> &pqueue = getQueue<T> ();
+
   SCORE score = SCORE ();
-  calculateScores (score);
+  calculateScores<T> (score);
   scores.push_back (score);
 
   unsigned int iter = 0;
   unsigned int M = getM ();
+
+  //  With --reorder, the experiments are printed in the order of the data file
+  vector<unsigned int> order (original_ids.size ());
+  for (iter = 0; iter < original_ids.size (); iter++) {
+    order[original_ids[iter]] = iter;
+  }
+
   for (iter = 0; iter < M; iter++) {
     //  Build a new graph, output the MST, and then destroy it
     GRAPH *g = new GRAPH (M - iter, pqueue, clusters);
     g -> printEdges (iter, clusters, getPath ());
-    g -> printNodes (iter, clusters, getPath ());
+    g -> printNodes (iter, clusters, order, getPath ());
     delete g;
 
     //  Find the next merge
@@ -102,12 +182,19 @@ void BUILDMST::run () {
       if (pqueue.empty ()) {
         break;
       }
-      HEAPNODE heapnode = pqueue.top ();
+      HEAPNODE<T> heapnode = pqueue.top ();
       pqueue.pop ();
       //  If not yet merged
       unsigned int left = heapnode.getLeft ();
       unsigned int right = heapnode.getRight ();
       if ((!clusters.at (left).haveAncestors ()) && (!clusters.at (right).haveAncestors ())) {
+        //  With --quantize, the linkage may only be a lower bound; put
+        //    the merge back with its exact linkage if it changes
+        T exact = 0;
+        if (refineLinkage<T> (left, right, exact)) {
+          pqueue.push (HEAPNODE<T> (left, right, exact));
+          continue;
+        }
         success = true;
 
         if (getDebug ()) {
@@ -117,16 +204,18 @@ void BUILDMST::run () {
         }
         //  Create a new microarray vector in position clusters.size ().  The name of this merged node
         //  is clusters.size () - (number of rows in microarray).  i.e., from 0.
-        CLUSTER c = CLUSTER (clusters.size (), &clusters[left], &clusters[right], getLinkage (), getM ());
+        checkSketch (left, right, heapnode.getScore ());
+
+        CLUSTER c = CLUSTER (clusters.size (), &clusters[left], &clusters[right], getLinkage (), getM (), &data);
         clusters.push_back (c);
 
         //  Calculate the similarity between this new node and every other node;
         //  add to the heap by pushing new edges on
-        calculateLinkage (c);
+        calculateLinkage<T> (c);
 
         //  Add the score in
         score = SCORE (iter + 1, left, right);
-        calculateScores (score);
+        calculateScores<T> (score);
         scores.push_back (score);
       }
       else {
@@ -137,10 +226,5 @@ void BUILDMST::run () {
     } while (!success);
   }
 
-  //  Normalize the scores to 0..100
-  normalizeScores ();
-
-  printScores (getPath ());
-
   return;
 }
@@ -51,6 +51,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <cstdint>  //  uint64_t
 #include <cmath>  //  fabs
 #include <climits>  //  UINT_MAX
 #include <cfloat>  //  DBL_MAX
@@ -59,7 +60,10 @@ using namespace std;
 
 #include "global_defn.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
 #include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
 #include "cluster.hpp"
 #include "score.hpp"
 
@@ -164,7 +168,8 @@ double SCORE::getCombinedScore () const {
      inter-cluster distance.  Once this is found, we set it and take the absolute
      value of their difference.
 */
-void SCORE::scoreGaps (unsigned int M, vector<CLUSTER> *clusters, double **d, bool debug) {
+template <typename T>
+void SCORE::scoreGaps (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<T> *d, bool debug) {
   unsigned int i = 0;  //  Position i
   unsigned int j = 0;  //  Position j
   unsigned int max_items = 0;
@@ -214,15 +219,15 @@ void SCORE::scoreGaps (unsigned int M, vector<CLUSTER> *clusters, double **d, bo
     for (j = i + 1; j < M; j++) {
       if (distance_to_cluster[i][j]) {
         //  Intra-cluster score
-        if (d[i][j] > intra_max) {
-          intra_max = d[i][j];
+        if (d -> get (i, j) > intra_max) {
+          intra_max = d -> get (i, j);
           intra_count++;
         }
       }
       else {
         //  Inter-cluster score
-        if (d[i][j] < inter_min) {
-          inter_min = d[i][j];
+        if (d -> get (i, j) < inter_min) {
+          inter_min = d -> get (i, j);
           inter_count++;
         }
       }
@@ -263,7 +268,8 @@ void SCORE::scoreGaps (unsigned int M, vector<CLUSTER> *clusters, double **d, bo
      over the data (the first to get the mean; the second to calculate the sums of
      squares).
 */
-void SCORE::scoreANOVA (unsigned int M, vector<CLUSTER> *clusters, double **d, bool debug) {
+template <typename T>
+void SCORE::scoreANOVA (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<T> *d, bool debug) {
   unsigned int i = 0;  //  Position i
   unsigned int j = 0;  //  Position j
   unsigned int max_items = 0;
@@ -314,18 +320,18 @@ void SCORE::scoreANOVA (unsigned int M, vector<CLUSTER> *clusters, double **d, b
   //  Use distance_to_cluster to scan the upper-triangular distance matrix
   for (i = 0; i < M; i++) {
     for (j = i + 1; j < M; j++) {
-      mean += d[i][j];
+      mean += d -> get (i, j);
       if (distance_to_cluster[i][j]) {
         //  Intra-cluster score
-        intra_scores.push_back (d[i][j]);
-        intra_mean += d[i][j];
-        mean += d[i][j];
+        intra_scores.push_back (d -> get (i, j));
+        intra_mean += d -> get (i, j);
+        mean += d -> get (i, j);
       }
       else {
         //  Inter-cluster score
-        inter_scores.push_back (d[i][j]);
-        inter_mean += d[i][j];
-        mean += d[i][j];
+        inter_scores.push_back (d -> get (i, j));
+        inter_mean += d -> get (i, j);
+        mean += d -> get (i, j);
       }
     }
   }
@@ -397,7 +403,8 @@ void SCORE::scoreANOVA (unsigned int M, vector<CLUSTER> *clusters, double **d, b
      Malik (2000).
 
 */
-void SCORE::scoreNormalizedAssoc (unsigned int M, vector<CLUSTER> *clusters, double **d, bool debug) {
+template <typename T>
+void SCORE::scoreNormalizedAssoc (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<T> *d, bool debug) {
   unsigned int i = 0;  //  Position i
   unsigned int j = 0;  //  Position j
   unsigned int max_items = 0;
@@ -472,8 +479,8 @@ void SCORE::scoreNormalizedAssoc (unsigned int M, vector<CLUSTER> *clusters, dou
     for (j = i + 1; j < M; j++) {
       if (distance_to_cluster[i][j] != UINT_MAX) {
         //  Intra-cluster edge
-//         cerr << "** Add " << d[i][j] << " at (" << i << ", " << j << ") to " << distance_to_cluster[i][j] << endl;
-        assoc_self[distance_to_cluster[i][j]] += d[i][j];
+//         cerr << "** Add " << d -> get (i, j) << " at (" << i << ", " << j << ") to " << distance_to_cluster[i][j] << endl;
+        assoc_self[distance_to_cluster[i][j]] += d -> get (i, j);
       }
     }
   }
@@ -483,8 +490,8 @@ void SCORE::scoreNormalizedAssoc (unsigned int M, vector<CLUSTER> *clusters, dou
     unsigned int cluster_id = distance_to_cluster[i][i];
     for (j = 0; j < M; j++) {
 //       if (distance_to_cluster[i][j] == UINT_MAX) {
-//         cerr << "Add " << d[i][j] << " at (" << i << ", " << j << ") to " << cluster_id << endl;
-        assoc_all[cluster_id] += d[i][j];
+//         cerr << "Add " << d -> get (i, j) << " at (" << i << ", " << j << ") to " << cluster_id << endl;
+        assoc_all[cluster_id] += d -> get (i, j);
 //       }
     }
   }
@@ -532,7 +539,8 @@ void SCORE::scoreNormalizedAssoc (unsigned int M, vector<CLUSTER> *clusters, dou
      See SCORE::scoreNormalizedAssocOrig for a description.  Only difference is that
      the score is not multiplied by the number of clusters.
 */
-void SCORE::scoreNormalizedAssocOrig (unsigned int M, vector<CLUSTER> *clusters, double **d, bool debug) {
+template <typename T>
+void SCORE::scoreNormalizedAssocOrig (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<T> *d, bool debug) {
   unsigned int i = 0;  //  Position i
   unsigned int j = 0;  //  Position j
   unsigned int max_items = 0;
@@ -607,8 +615,8 @@ void SCORE::scoreNormalizedAssocOrig (unsigned int M, vector<CLUSTER> *clusters,
     for (j = i + 1; j < M; j++) {
       if (distance_to_cluster[i][j] != UINT_MAX) {
         //  Intra-cluster edge
-//         cerr << "** Add " << d[i][j] << " at (" << i << ", " << j << ") to " << distance_to_cluster[i][j] << endl;
-        assoc_self[distance_to_cluster[i][j]] += d[i][j];
+//         cerr << "** Add " << d -> get (i, j) << " at (" << i << ", " << j << ") to " << distance_to_cluster[i][j] << endl;
+        assoc_self[distance_to_cluster[i][j]] += d -> get (i, j);
       }
     }
   }
@@ -618,8 +626,8 @@ void SCORE::scoreNormalizedAssocOrig (unsigned int M, vector<CLUSTER> *clusters,
     unsigned int cluster_id = distance_to_cluster[i][i];
     for (j = 0; j < M; j++) {
 //       if (distance_to_cluster[i][j] == UINT_MAX) {
-//         cerr << "Add " << d[i][j] << " at (" << i << ", " << j << ") to " << cluster_id << endl;
-        assoc_all[cluster_id] += d[i][j];
+//         cerr << "Add " << d -> get (i, j) << " at (" << i << ", " << j << ") to " << cluster_id << endl;
+        assoc_all[cluster_id] += d -> get (i, j);
 //       }
     }
   }
@@ -660,3 +668,13 @@ void SCORE::scoreNormalizedAssocOrig (unsigned int M, vector<CLUSTER> *clusters,
 
   return;
 }
+
+//  Instantiate the scoring functions for each precision of the distance matrix
+template void SCORE::scoreGaps (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<float> *d, bool debug);
+template void SCORE::scoreGaps (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<double> *d, bool debug);
+template void SCORE::scoreANOVA (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<float> *d, bool debug);
+template void SCORE::scoreANOVA (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<double> *d, bool debug);
+template void SCORE::scoreNormalizedAssoc (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<float> *d, bool debug);
+template void SCORE::scoreNormalizedAssoc (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<double> *d, bool debug);
+template void SCORE::scoreNormalizedAssocOrig (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<float> *d, bool debug);
+template void SCORE::scoreNormalizedAssocOrig (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<double> *d, bool debug);
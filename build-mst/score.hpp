@@ -77,10 +77,14 @@ class SCORE {
     double getScore2 () const;
     double getCombinedScore () const;
 
-    void scoreGaps (unsigned int M, vector<CLUSTER> *clusters, double **d, bool debug);
-    void scoreANOVA (unsigned int M, vector<CLUSTER> *clusters, double **d, bool debug);
-    void scoreNormalizedAssoc (unsigned int M, vector<CLUSTER> *clusters, double **d, bool debug);
-    void scoreNormalizedAssocOrig (unsigned int M, vector<CLUSTER> *clusters, double **d, bool debug);
+    template <typename T>
+    void scoreGaps (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<T> *d, bool debug);
+    template <typename T>
+    void scoreANOVA (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<T> *d, bool debug);
+    template <typename T>
+    void scoreNormalizedAssoc (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<T> *d, bool debug);
+    template <typename T>
+    void scoreNormalizedAssocOrig (unsigned int M, vector<CLUSTER> *clusters, const DISTMATRIX<T> *d, bool debug);
   private:
     //!  The merge ID, numbered from 0
     unsigned int id;
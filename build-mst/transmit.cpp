@@ -0,0 +1,243 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file transmit.cpp
+    Additional member functions for BUILDMST class definition
+      Splitting the distance matrix between MPI processes
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <iostream>  //  cerr, endl
+#include <iomanip>  //  setw
+#include <string>
+#include <vector>
+#include <queue>  //  priority_queue
+
+#include <algorithm>  //  min, max
+
+#include <cstdint>  //  uint64_t
+
+using namespace std;
+
+#include "BuildMSTConfig.hpp"
+
+#if HAVE_MPI
+#include <boost/mpi/communicator.hpp>
+#include <boost/mpi/collectives.hpp>  //  broadcast
+using boost::mpi::communicator;
+using boost::mpi::broadcast;
+#endif
+
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+#include "heapnode.hpp"
+#include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect.hpp"
+#include "expr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "cluster.hpp"
+#include "score.hpp"
+#include "build_mst.hpp"
+
+/*!
+     If build-mst is started with mpirun, every process reads the options
+     and the data (so the files must be visible to all of them) and the
+     distance matrix is split between them by columns.  Since the tiles
+     of a DISTMATRIX are stored column of tiles by column of tiles, the
+     columns of each process are one contiguous piece of the matrix.  The
+     pieces are sent to the primary process (rank 0), which then builds
+     the MSTs on its own, as without MPI.
+
+     Within each process, the tiles are still shared between --threads
+     threads.  Without MPI (or with one process), this process calculates
+     every column.
+*/
+
+
+//!  Tell the other processes whether the primary process found the distances in the cache
+/*!
+     \param arg Whether or not the distances were found (only used on the primary process)
+     \return Whether or not the distances were found
+
+     first_new is sent along, in case the cache entry was extended.
+*/
+bool BUILDMST::shareCached (bool arg) {
+#if HAVE_MPI
+  if (getWorldSize () > 1) {
+    communicator world;
+    broadcast (world, arg, 0);
+    broadcast (world, first_new, 0);
+  }
+#endif
+
+  return arg;
+}
+
+
+//!  Split the columns of the distance matrix between the processes
+/*!
+     \param bounds Filled with the first column of each process, followed by M
+
+     Column j holds j pairs, so the columns are split so that each process
+     has about the same number of pairs to calculate; columns before
+     first_new count for nothing, since they were copied from the cache.
+     Every bound is a multiple of DIST_MATRIX_TILE_ROWS (or M), so that
+     the columns of a process are made up of whole columns of tiles.  The
+     columns of tiles with copied pairs are always left to the primary
+     process, since the other processes do not have the copies.
+*/
+void BUILDMST::splitColumns (vector<unsigned int> &bounds) const {
+  unsigned int m = getM ();
+  unsigned int tiles = (m + DIST_MATRIX_TILE_ROWS - 1) / DIST_MATRIX_TILE_ROWS;
+  unsigned int t = 0;
+  unsigned int r = 0;
+  double total = 0.0;
+
+  //  Number of pairs before each column of tiles
+  vector<double> before (tiles + 1, 0.0);
+  for (t = 0; t < tiles; t++) {
+    double pairs = 0.0;
+    for (unsigned int j = t * DIST_MATRIX_TILE_ROWS; j < min ((t + 1) * DIST_MATRIX_TILE_ROWS, m); j++) {
+      if (j >= first_new) {
+        pairs += j;
+      }
+    }
+    total += pairs;
+    before[t + 1] = total;
+  }
+
+  //  Each bound is the column of tiles closest to its share of the pairs
+  unsigned int lowest = min ((first_new + DIST_MATRIX_TILE_ROWS - 1) / DIST_MATRIX_TILE_ROWS * DIST_MATRIX_TILE_ROWS, m);
+  bounds.assign (getWorldSize () + 1, m);
+  bounds[0] = 0;
+  t = 0;
+  for (r = 1; r < getWorldSize (); r++) {
+    unsigned int last = t;
+    double share = total * r / getWorldSize ();
+    while ((t < tiles) && (before[t] < share)) {
+      t++;
+    }
+    if ((t > last) && (share - before[t - 1] < before[t] - share)) {
+      t--;
+    }
+    bounds[r] = max (min (t * DIST_MATRIX_TILE_ROWS, m), lowest);
+  }
+}
+
+
+//!  Choose the columns of the distance matrix calculated by this process
+/*!
+     Processes other than the primary one keep only their own columns in
+     memory, no matter where the primary process keeps the matrix.
+*/
+void BUILDMST::distributeColumns () {
+  vector<unsigned int> bounds;
+
+  splitColumns (bounds);
+  column_begin = bounds[getRank ()];
+  column_end = bounds[getRank () + 1];
+
+  if (getRank () != 0) {
+    if (getPrecision () == PREC_FLOAT) {
+      dist_float.allocateColumns (getM (), column_begin, column_end);
+    }
+    else {
+      dist_double.allocateColumns (getM (), column_begin, column_end);
+    }
+  }
+
+  if ((getVerbose ()) && (getWorldSize () > 1)) {
+    cerr << left << setw (VERBOSE_WIDTH) << "==\tPrimary process columns:" << column_begin << " to " << column_end << " of " << getM () << endl;
+  }
+
+  return;
+}
+
+
+//!  Send the columns calculated by each process to the primary process
+/*!
+     T is the precision of the distance matrix.  The columns are sent in
+     messages of at most DIST_MPI_CHUNK distances, straight into the
+     matrix of the primary process (which may be a memory-mapped file).
+*/
+template <typename T>
+void BUILDMST::gatherDistances () {
+#if HAVE_MPI
+  if (getWorldSize () == 1) {
+    return;
+  }
+
+  communicator world;
+  DISTMATRIX<T> &dist_matrix = getDistMatrix<T> ();
+  vector<unsigned int> bounds;
+  unsigned int r = 0;
+
+  splitColumns (bounds);
+  for (r = 1; r < getWorldSize (); r++) {
+    if ((getRank () != 0) && (getRank () != r)) {
+      continue;
+    }
+
+    size_t count = DISTMATRIX<T>::countColumns (bounds[r], bounds[r + 1]);
+    T *values = dist_matrix.getColumns (bounds[r]);
+    for (size_t k = 0; k < count; k += DIST_MPI_CHUNK) {
+      int size = static_cast<int> (min (count - k, static_cast<size_t> (DIST_MPI_CHUNK)));
+      if (getRank () == 0) {
+        world.recv (r, 0, values + k, size);
+      }
+      else {
+        world.send (0, 0, values + k, size);
+      }
+    }
+  }
+#endif
+
+  return;
+}
+
+//  Instantiate the gathering for each precision
+template void BUILDMST::gatherDistances<float> ();
+template void BUILDMST::gatherDistances<double> ();
+
@@ -51,69 +51,23 @@
 #include <vector>
 #include <iostream>  //  cerr, endl
 
-#include <boost/tokenizer.hpp>
-#include <boost/lexical_cast.hpp>
+#include <cstdint>  //  uint64_t
 
 using namespace std;
-using namespace boost;
 
 #include "global_defn.hpp"
-#include "check.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
 #include "vect.hpp"
 
 //!  Default constructor that takes no arguments
 VECT::VECT ()
-  : id (0),
-    name (""),
-    colour (DEFAULT_COLOUR),
-    shape (DEFAULT_SHAPE),
+  : n (0),
     exprs (),
     nulls ()
 {
 }
 
-//!  Constructor that takes two arguments
-/*!
-     \param arg1 ID of the vector
-     \param arg2 The row from the microarray data file, represented as a string
-*/
-VECT::VECT (unsigned int arg1, string arg2)
-  : id (arg1),
-    name (""),
-    colour (DEFAULT_COLOUR),
-    shape (DEFAULT_SHAPE),
-    exprs (),
-    nulls ()
-{
-  typedef tokenizer<char_separator<char> > tokenizer;
-  char_separator<char> sep ("\t");  //  Must be tab-separated
-  tokenizer tokens (arg2, sep);
-
-  //  Grab the name of the vector (first column)
-  tokenizer::iterator beg = tokens.begin ();
-  setName (*beg);
-  beg++;
-
-  for (; beg != tokens.end (); ++beg) {
-    if (*beg == "NULL") {
-      exprs.push_back (NULL_EXPR);
-      nulls.push_back (true);
-    }
-    else {
-      try {
-        exprs.push_back (lexical_cast<double>(*beg));
-      }
-      catch (bad_lexical_cast &) {
-        cerr << "\nUnexpected error in reading in microarray data.\nExpecting the keyword \"NULL\" or a double value, but found this instead:  " << *beg << "\nExiting...\n\n";
-        exit (EXIT_FAILURE);
-      }
-      nulls.push_back (false);
-    }
-//       cout << *beg << endl;
-  }
-}
-
 //!  Constructor that takes a single argument
 /*!
      \param values A vector of SPEARMAN nodes
@@ -124,10 +78,7 @@ VECT::VECT (unsigned int arg1, string arg2)
      and would have all been pushed to one side.
 */
 VECT::VECT (vector<SPEARMAN> values)
-  : id (0),
-    name (""),
-    colour (DEFAULT_COLOUR),
-    shape (DEFAULT_SHAPE),
+  : n (0),
     exprs (),
     nulls ()
 {
@@ -135,8 +86,7 @@ VECT::VECT (vector<SPEARMAN> values)
   unsigned int size = values.size ();
 
   for (i = 0; i < size; i++) {
-    exprs.push_back (values[i].getRank ());
-    nulls.push_back (false);
+    pushExpr (values[i].getRank (), false);
   }
 
   return;
@@ -146,74 +96,55 @@ VECT::VECT (vector<SPEARMAN> values)
 /*!
      \param src The source that we are copying from
 
-     This function is used to copy the two vectors an element at a time.
      The function receives a reference to prevent infinite recursion.
 */
 VECT::VECT (const VECT &src)
-  : id (src.id),
-    name (src.name),
-    colour (src.colour),
-    shape (src.shape),
-    exprs (),
-    nulls ()
+  : n (src.n),
+    exprs (src.exprs),
+    nulls (src.nulls)
 {
-   const unsigned int size = src.getN ();
-
-   //  Copy the two arrays one element at a time
-   for (unsigned int i = 0; i < size; i++) {
-     exprs.push_back (src.getExpr (i));
-     nulls.push_back (src.getNull (i));
-   }
-}
-
-//!  Set the ID
-void VECT::setID (unsigned int arg) {
-  id = arg;
-}
-
-//!  Get the ID
-unsigned int VECT::getID () const {
-  return id;
-}
-
-//!  Set the name
-void VECT::setName (string arg) {
-  name = sanitizeSampleName (arg);
-}
-
-//!  Get the name
-string VECT::getName () const {
-  return name;
-}
-
-//!  Set the colour
-void VECT::setColour (string arg) {
-  colour = arg;
 }
 
-//!  Get the colour
-string VECT::getColour () const {
-  return colour;
-}
+//!  Resize the vector
+/*!
+     In order to resize the VECT object, we have to keep exprs and
+     nulls the same length at all times; so we change both
+     simultaneously here.  Any new columns are flagged as NULL.
+*/
+void VECT::resize (unsigned int arg) {
+  unsigned int i = 0;
 
-//!  Set the shape
-void VECT::setShape (string arg) {
-  shape = arg;
-}
+  n = arg;
+  exprs.resize (((arg + SIMD_LANES - 1) / SIMD_LANES) * SIMD_LANES, 0.0);
+  nulls.resize ((arg + NULL_WORD_BITS - 1) / NULL_WORD_BITS, ~static_cast<uint64_t> (0));
 
-//!  Get the shape
-string VECT::getShape () const {
-  return shape;
+  //  Clear the padding if the vector has shrunk
+  for (i = arg; i < exprs.size (); i++) {
+    exprs[i] = 0.0;
+  }
+  if (arg % NULL_WORD_BITS != 0) {
+    nulls.back () |= ~static_cast<uint64_t> (0) << (arg % NULL_WORD_BITS);
+  }
 }
 
-//!  Resize the vector
+//!  Append an expression level to the end of the vector
 /*!
-     In order to resize the VECT object, we have to keep the lengths
-     of both exprs and nulls the same at all times; so we change
-     both simultaneously here.
+     \param value The expression level
+     \param null Whether or not the expression level is NULL
+
+     Space is added one block of columns at a time; since the new padding
+     is flagged as NULL, only the new column needs to be set.
 */
-void VECT::resize (unsigned int arg) {
-  exprs.resize (arg);
-  nulls.resize (arg);
+void VECT::pushExpr (double value, bool null) {
+  if (n % SIMD_LANES == 0) {
+    exprs.resize (n + SIMD_LANES, 0.0);
+  }
+  if (n % NULL_WORD_BITS == 0) {
+    nulls.push_back (~static_cast<uint64_t> (0));
+  }
+
+  exprs[n] = value;
+  putNull (n, null);
+  n++;
 }
 
@@ -51,39 +51,27 @@
 #define VECT_HPP
 
 /*!
-     The VECT class represents a vector (or row) in a microarray
-     data file.  Each instance has attributes such as a name,
-     colour, and shape.  Also, they have a vector of expression
-     levels and a vector of null values.  The lengths of these
-     two vectors are identical and match one-to-one.  That is,
-     if the value in position (column) i is NULL, then the
-     expression level is a 0 (and should not be used).
-
-     Since dissimilarity functions operate between two vectors,
-     these functions are part of this class but are in their own
-     file.
+     The VECT class represents a vector of expression levels which
+     is not part of the expression matrix (EXPRMATRIX), such as the
+     centroid of a cluster.  Each instance has a vector of expression
+     levels and a bitmap of null values, one bit per column.  That
+     is, if the value in position (column) i is NULL, then bit i is
+     set and the expression level is a 0 (and should not be used).
+     The expression levels are padded with zeroes to a multiple of
+     SIMD_LANES and the padding is flagged as NULL, so that the
+     distance kernels can work on whole blocks of columns.
+
+     Dissimilarity functions are applied to the EXPRROW view returned
+     by getRow ().
 */
 class VECT {
   public:
     VECT ();
-    VECT (unsigned int arg1, string arg2);
     VECT (vector<SPEARMAN> values);
     VECT (const VECT &src);
 
 //     const VECT &operator= (const VECT &rhs);
 
-    //  Mutators
-    void setID (unsigned int arg);
-    void setName (string arg);
-    void setColour (string arg);
-    void setShape (string arg);
-
-    //  Accessors
-    unsigned int getID () const;
-    string getName () const;
-    string getColour () const;
-    string getShape () const;
-
     //!  Get the expression level at position i
     inline double getExpr (unsigned int i) const {
       return exprs[i];
@@ -91,12 +79,12 @@ class VECT {
 
     //!  Get the NULL flag at position i
     inline bool getNull (unsigned int i) const {
-      return nulls[i];
+      return ((nulls[i / NULL_WORD_BITS] >> (i % NULL_WORD_BITS)) & 1);
     }
 
     //!  Test if the expression level in position i is NULL
     inline bool isNull (unsigned int i) {
-      return nulls[i];
+      return ((nulls[i / NULL_WORD_BITS] >> (i % NULL_WORD_BITS)) & 1);
     }
 
     //!  Put the expression level at position i
@@ -106,38 +94,39 @@ class VECT {
 
     //!  Put the NULL value (true or false) at position i
     inline void putNull (unsigned int pos, bool value) {
-      nulls[pos] = value;
+      uint64_t bit = static_cast<uint64_t> (1) << (pos % NULL_WORD_BITS);
+
+      if (value) {
+        nulls[pos / NULL_WORD_BITS] |= bit;
+      }
+      else {
+        nulls[pos / NULL_WORD_BITS] &= ~bit;
+      }
     }
 
     //!  Get the size of the vector
     /*!
-         Note that since exprs and nulls are the same size,
-         we could have also returned the size of exprs.
+         This is the number of columns, not including the padding.
     */
     inline unsigned int getN () const {
-      return nulls.size ();
+      return n;
     }
 
-    void resize (unsigned int arg);
+    //!  Get a view of the vector for calculating distances
+    inline EXPRROW getRow () const {
+      return EXPRROW (n == 0 ? NULL : &exprs[0], n == 0 ? NULL : &nulls[0], n);
+    }
 
-    //  Dissimilarity functions  [vect_dist.cpp]
-    double simEuc (VECT *other);
-    double simMan (VECT *other);
-    double simPear (VECT *other);
-    double simSpear (VECT *other);
+    void resize (unsigned int arg);
   private:
-    //!  ID of this vector (or row)
-    unsigned int id;
-    //!  Name of the experiment corresponding to this vector
-    string name;
-    //!  Colour of the experiment corresponding to this vector
-    string colour;
-    //!  Shape of the experiment corresponding to this vector
-    string shape;
-    //!  Vector of expression levels
+    void pushExpr (double value, bool null);
+
+    //!  Number of columns
+    unsigned int n;
+    //!  Vector of expression levels, padded with zeroes to a multiple of SIMD_LANES
     vector<double> exprs;
-    //!  Vector of NULL levels as a boolean flag (TRUE = NULL expression level)
-    vector<bool> nulls;
+    //!  Bitmap of NULL flags (set = NULL expression level); the padding is flagged as NULL
+    vector<uint64_t> nulls;
 };
 
 #endif
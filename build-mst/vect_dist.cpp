@@ -33,7 +33,7 @@
 /*******************************************************************/
 /*!
     \file vect_dist.cpp
-    Additional member functions for VECT class definition
+    Additional member functions for EXPRROW class definition
       Functions for calculating distances between two vectors
     
     \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
@@ -51,82 +51,84 @@
 #include <iostream>  //  cerr, endl
 #include <string>
 #include <vector>
-#include <algorithm>  //  sort
 
-#include <cmath>  //  fabs, sqrt
+#include <cstdint>  //  uint64_t
+#include <cmath>  //  sqrt
 #include <cfloat>  //  DBL_MAX
 #include <cstdlib>  //  exit, EXIT_FAILURE
+#include <climits>  //  UINT_MAX
 
 using namespace std;
 
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
 #include "vect_spear.hpp"
+#include "expr_row.hpp"
+#include "vect_kendall.hpp"
+#include "vect_mi.hpp"
 #include "vect.hpp"
 
 //!  The Euclidean distance between this vector and another one
-/*!  Function exits if the two vectors are of different dimensions.  */
-double VECT::simEuc (VECT *other) {
-  unsigned int i = 0;
+/*!
+     Differences are only taken where both expression levels are
+     non-null.  Function exits if the two vectors are of different
+     dimensions.
+
+     P is the NULL profile of the two rows (the worse of the two).  If
+     neither row has NULLs, then the NULL bitmaps are not read at all.
+     The same applies to simMan () and simPear ().
+*/
+template <NULL_PROFILE P>
+double EXPRROW::simEuc (const EXPRROW &other) const {
   double result = 0;
-  double temp = 0;
+  double lanes[SIMD_LANES];
   unsigned int size = 0;
-  unsigned int n = nulls.size ();
 
   //  Ensure both rows are of the same dimensions
-  if (getN () != other -> getN ()) {
+  if (getN () != other.getN ()) {
     cerr << "Error:  Dimensions differ!" << endl;
     exit (EXIT_FAILURE);
   }
 
-  //  First calculate differences between each pair of numbers
-  //  and squared, provided both are non-null
-  for (i = 0; i < n; i++) {
-    if (!(this -> isNull (i)) && !(other -> isNull (i))) {
-      temp = (this -> getExpr (i)) - (other -> getExpr (i));
-      temp = temp * temp;
-      result += temp;
-      size++;
-    }
-  }
-
+  size = (P == NULLS_NONE) ? n : countNonNull (nulls, other.nulls, getWords ());
   if (size == 0) {
-    result = DBL_MAX;
-  }
-  else {
-    //  Sqrt number
-    result = sqrt (result);
+    return (DBL_MAX);
   }
 
+  //  Sum the squared differences and then take the square root
+  sumSqDiff<P> (exprs, nulls, other.exprs, other.nulls, n, lanes);
+  result = sqrt (sumLanes (lanes));
+
   return (result);
 }
 
 
 //!  The Manhattan distance between this vector and another one
-/*!  Function exits if the two vectors are of different dimensions.  */
-double VECT::simMan (VECT *other) {
-  unsigned int i = 0;
+/*!
+     Differences are only taken where both expression levels are
+     non-null.  Function exits if the two vectors are of different
+     dimensions.
+*/
+template <NULL_PROFILE P>
+double EXPRROW::simMan (const EXPRROW &other) const {
   double result = 0;
+  double lanes[SIMD_LANES];
   unsigned int size = 0;
-  unsigned int n = nulls.size ();
 
   //  Ensure both rows are of the same dimensions
-  if (getN () != other -> getN ()) {
+  if (getN () != other.getN ()) {
     cerr << "Error:  Dimensions differ!" << endl;
     exit (EXIT_FAILURE);
   }
 
-  //  First calculate differences between each pair of numbers
-  //  and squared, provided both are non-null
-  for (i = 0; i < n; i++) {
-    if (!(this -> isNull (i)) && !(other -> isNull (i))) {
-      result += fabs ((this -> getExpr (i)) - (other -> getExpr (i)));
-      size++;
-    }
-  }
-
+  size = (P == NULLS_NONE) ? n : countNonNull (nulls, other.nulls, getWords ());
   if (size == 0) {
-    result = DBL_MAX;
+    return (DBL_MAX);
   }
 
+  sumAbsDiff<P> (exprs, nulls, other.exprs, other.nulls, n, lanes);
+  result = sumLanes (lanes);
+
   return (result);
 }
 
@@ -141,9 +143,8 @@ double VECT::simMan (VECT *other) {
 
      Note:  The calculation makes use of the population standard deviation.
 */
-double VECT::simPear (VECT *other) {
-  unsigned int n = nulls.size ();
-  unsigned int i = 0;
+template <NULL_PROFILE P>
+double EXPRROW::simPear (const EXPRROW &other) const {
   unsigned int n2 = 0;  //  Number of non-null pairs
   double result = 0;
   double sumxy = 0;
@@ -154,23 +155,23 @@ double VECT::simPear (VECT *other) {
   double num = 0;
   double den1 = 0;
   double den2 = 0;
+  double lanes[5 * SIMD_LANES];
 
   //  Ensure both rows are of the same dimensions
-  if (getN () != other -> getN ()) {
+  if (getN () != other.getN ()) {
     cerr << "Error:  Dimensions differ!" << endl;
     exit (EXIT_FAILURE);
   }
 
-  //  Calculate average of both genes
-  for (i = 0; i < n; i++) {
-    if (!(this -> isNull (i)) && !(other -> isNull (i))) {
-      sumxy += (this -> getExpr (i)) * (other -> getExpr (i));
-      sumx += (this -> getExpr (i));
-      sumy += (other -> getExpr (i));
-      sumx_sqr += (this -> getExpr (i)) * (this -> getExpr (i));
-      sumy_sqr += (other -> getExpr (i)) * (other -> getExpr (i));
-      n2++;
-    }
+  //  Calculate the sums over both genes
+  n2 = (P == NULLS_NONE) ? n : countNonNull (nulls, other.nulls, getWords ());
+  if (n2 != 0) {
+    sumPearson<P> (exprs, nulls, other.exprs, other.nulls, n, lanes);
+    sumxy = sumLanes (lanes);
+    sumx = sumLanes (lanes + SIMD_LANES);
+    sumy = sumLanes (lanes + 2 * SIMD_LANES);
+    sumx_sqr = sumLanes (lanes + 3 * SIMD_LANES);
+    sumy_sqr = sumLanes (lanes + 4 * SIMD_LANES);
   }
 
   num = (static_cast<double> (n2) * sumxy) - (sumx * sumy);
@@ -202,97 +203,200 @@ double VECT::simPear (VECT *other) {
      The final result is a distance whose range is [0, 2] such that 0 means two
      vectors are highly correlated.
 */
-double VECT::simSpear (VECT *other) {
+double EXPRROW::simSpear (const EXPRROW &other) const {
   unsigned int i = 0;
-  unsigned int j = 0;
-  unsigned int k = 0;
   unsigned int n2 = 0;  //  Number of non-null pairs
   double result = 0.0;
   vector<SPEARMAN> myspears;
   vector<SPEARMAN> otherspears;
 
   //  Ensure both rows are of the same dimensions
-  if (getN () != other -> getN ()) {
+  if (getN () != other.getN ()) {
     cerr << "Error:  Dimensions differ!" << endl;
     exit (EXIT_FAILURE);
   }
 
   //  Add to spearman node
   for (i = 0; i < getN (); i++) {
-    if (!(this -> isNull (i)) && !(other -> isNull (i))) {
+    if (!(this -> isNull (i)) && !(other.isNull (i))) {
       myspears.push_back (SPEARMAN (getExpr (i), n2, 0));
-      otherspears.push_back (SPEARMAN (other -> getExpr (i), n2, 0));
+      otherspears.push_back (SPEARMAN (other.getExpr (i), n2, 0));
       n2++;
     }
   }
 
-  //  Sort vector of spearman nodes by value
-  sort (myspears.begin (), myspears.end ());
-  sort (otherspears.begin (), otherspears.end ());
+  //  Rank the non-null values of each vector separately
+  rankSpearman (myspears);
+  rankSpearman (otherspears);
+
+  //  Copy SPEARMAN nodes to VECT objects so that we can apply simPear to it;
+  //  the ranks do not have any NULLs
+  VECT myrow = VECT (myspears);
+  VECT otherrow = VECT (otherspears);
+
+  //  Calculate Pearson correlation
+  result = myrow.getRow ().simPear<NULLS_NONE> (otherrow.getRow ());
+
+  return result;
+}
 
-  //  Assign rank
-  for (i = 0; i < n2; i++) {
-    myspears[i].setRank (i);
-    otherspears[i].setRank (i);
+//!  The Kendall rank correlation coefficient (distance) between this vector and another one
+/*!
+     Both rows are presorted here and then compared with distKendall (),
+     using only the columns that are non-null in both rows.  When many
+     pairs are calculated, BUILDMST presorts each row once instead (see
+     prepareKendall ()); this function is used for the centroids.
+     Function exits if the two vectors are of different dimensions.
+*/
+double EXPRROW::simKendall (const EXPRROW &other) const {
+  //  Ensure both rows are of the same dimensions
+  if (getN () != other.getN ()) {
+    cerr << "Error:  Dimensions differ!" << endl;
+    exit (EXIT_FAILURE);
+  }
+  if (getN () == 0) {
+    return 2.0;
   }
 
-  //  Handle duplicate ranks for myspears
-  i = 0;
-  while (i < n2) {
-    unsigned int dups = 1;
-    double ranksum = myspears[i].getRank ();
-    for (j = i + 1; j < n2; j++) {
-      if (myspears[i].getValue () != myspears[j].getValue ()) {
-        break;
-      }
-      else {
-        ranksum += myspears[j].getRank ();
-        dups++;
-      }
-    }
-    for (k = i; k < j; k++) {
-      myspears[k].setRank (ranksum / dups);
-    }
-    i = j;
+  vector<unsigned int> myorder (getN ());
+  vector<unsigned int> myranks (getN ());
+  vector<unsigned int> otherorder (getN ());
+  vector<unsigned int> otherranks (getN ());
+
+  unsigned int mycount = presortKendall (*this, &myorder[0], &myranks[0]);
+  presortKendall (other, &otherorder[0], &otherranks[0]);
+
+  return (distKendall (&myorder[0], mycount, &myranks[0], &otherranks[0]));
+}
+
+//!  The cosine similarity (distance) between this vector and another one
+/*!
+     \param other The other vector
+     \param norm1 The norm of this vector (see getNorm ())
+     \param norm2 The norm of the other vector
+
+     The cosine similarity is subtracted from 1 to obtain a distance whose
+     range is [0, 2].  NULLs are treated as zeroes, so the products are
+     only taken where both expression levels are non-null but each norm
+     covers all of the non-null columns of its own row.  With the norms
+     passed in, each pair costs a single dot product.
+
+     Function exits if the two vectors are of different dimensions.
+*/
+template <NULL_PROFILE P>
+double EXPRROW::simCosine (const EXPRROW &other, double norm1, double norm2) const {
+  double lanes[SIMD_LANES];
+
+  //  Ensure both rows are of the same dimensions
+  if (getN () != other.getN ()) {
+    cerr << "Error:  Dimensions differ!" << endl;
+    exit (EXIT_FAILURE);
   }
 
-  //  Handle duplicate ranks for otherspears
-  i = 0;
-  while (i < n2) {
-    unsigned int dups = 1;
-    double ranksum = otherspears[i].getRank ();
-    for (j = i + 1; j < n2; j++) {
-      if (otherspears[i].getValue () != otherspears[j].getValue ()) {
-        break;
-      }
-      else {
-        ranksum += otherspears[j].getRank ();
-        dups++;
-      }
-    }
-    for (k = i; k < j; k++) {
-      otherspears[k].setRank (ranksum / dups);
-    }
-    i = j;
+  if (norm1 * norm2 == 0) {
+    //  Maximum possible distance
+    return 2.0;
   }
+  sumDot<P> (exprs, nulls, other.exprs, other.nulls, n, lanes);
+
+  return (1 - sumLanes (lanes) / (norm1 * norm2));
+}
+
+
+//!  The uncentered correlation coefficient (distance) between this vector and another one
+/*!
+     \param other The other vector
+     \param norm1 The norm of this vector (see getNorm ())
+     \param norm2 The norm of the other vector
 
-  //  Copy original positions to key
-  for (i = 0; i < n2; i++) {
-    myspears[i].copyOrigPosToKey ();
-    otherspears[i].copyOrigPosToKey ();
+     This is the Pearson correlation with both means taken to be zero,
+     which suits log-ratios.  Unlike simCosine (), NULLs are handled
+     pairwise:  the norms only cover the columns where both expression
+     levels are non-null.  So, the norms passed in are only used if
+     neither row has NULLs; otherwise, they are summed along with the dot
+     product.
+
+     Function exits if the two vectors are of different dimensions.
+*/
+template <NULL_PROFILE P>
+double EXPRROW::simUncentered (const EXPRROW &other, double norm1, double norm2) const {
+  double sumxy = 0;
+  double den = 0;
+  double lanes[3 * SIMD_LANES];
+
+  //  Ensure both rows are of the same dimensions
+  if (getN () != other.getN ()) {
+    cerr << "Error:  Dimensions differ!" << endl;
+    exit (EXIT_FAILURE);
   }
 
-  //  Sort by original positions
-  sort (myspears.begin (), myspears.end ());
-  sort (otherspears.begin (), otherspears.end ());
+  if ((P == NULLS_NONE) || (countNonNull (nulls, other.nulls, getWords ()) == n)) {
+    sumDot<P> (exprs, nulls, other.exprs, other.nulls, n, lanes);
+    sumxy = sumLanes (lanes);
+    den = norm1 * norm2;
+  }
+  else {
+    sumUncentered<P> (exprs, nulls, other.exprs, other.nulls, n, lanes);
+    sumxy = sumLanes (lanes);
+    den = sqrt (sumLanes (lanes + SIMD_LANES) * sumLanes (lanes + 2 * SIMD_LANES));
+  }
 
-  //  Copy SPEARMAN nodes to VECT objects so that we can apply simPear to it
-  VECT myrow = VECT (myspears);
-  VECT otherrow = VECT (otherspears);
+  if (den == 0) {
+    //  Maximum possible distance
+    return 2.0;
+  }
 
-  //  Calculate Pearson correlation
-  result = myrow.simPear (&otherrow);
+  return (1 - sumxy / den);
+}
 
-  return result;
+
+//!  The mutual information (distance) between this vector and another one
+/*!
+     Both rows are discretised here and then compared with
+     distMutualInfo ().  When many pairs are calculated, BUILDMST
+     discretises each row once instead (see prepareMutualInfo ()); this
+     function is used for the centroids.  Function exits if the two
+     vectors are of different dimensions.
+*/
+double EXPRROW::simMutualInfo (const EXPRROW &other) const {
+  //  Ensure both rows are of the same dimensions
+  if (getN () != other.getN ()) {
+    cerr << "Error:  Dimensions differ!" << endl;
+    exit (EXIT_FAILURE);
+  }
+
+  vector<uint8_t> mycodes (getN () + 1);
+  vector<uint8_t> othercodes (getN () + 1);
+
+  binMutualInfo (*this, &mycodes[0]);
+  binMutualInfo (other, &othercodes[0]);
+
+  return (distMutualInfo (&mycodes[0], &othercodes[0], getN ()));
+}
+
+
+//!  The norm of this vector, over its non-null columns
+double EXPRROW::getNorm () const {
+  double lanes[SIMD_LANES];
+
+  sumDot<NULLS_GENERAL> (exprs, nulls, exprs, nulls, n, lanes);
+
+  return (sqrt (sumLanes (lanes)));
 }
 
+//  Instantiate the dissimilarity functions for each NULL profile
+template double EXPRROW::simEuc<NULLS_NONE> (const EXPRROW &other) const;
+template double EXPRROW::simEuc<NULLS_SPARSE> (const EXPRROW &other) const;
+template double EXPRROW::simEuc<NULLS_GENERAL> (const EXPRROW &other) const;
+template double EXPRROW::simMan<NULLS_NONE> (const EXPRROW &other) const;
+template double EXPRROW::simMan<NULLS_SPARSE> (const EXPRROW &other) const;
+template double EXPRROW::simMan<NULLS_GENERAL> (const EXPRROW &other) const;
+template double EXPRROW::simPear<NULLS_NONE> (const EXPRROW &other) const;
+template double EXPRROW::simPear<NULLS_SPARSE> (const EXPRROW &other) const;
+template double EXPRROW::simPear<NULLS_GENERAL> (const EXPRROW &other) const;
+template double EXPRROW::simCosine<NULLS_NONE> (const EXPRROW &other, double norm1, double norm2) const;
+template double EXPRROW::simCosine<NULLS_SPARSE> (const EXPRROW &other, double norm1, double norm2) const;
+template double EXPRROW::simCosine<NULLS_GENERAL> (const EXPRROW &other, double norm1, double norm2) const;
+template double EXPRROW::simUncentered<NULLS_NONE> (const EXPRROW &other, double norm1, double norm2) const;
+template double EXPRROW::simUncentered<NULLS_SPARSE> (const EXPRROW &other, double norm1, double norm2) const;
+template double EXPRROW::simUncentered<NULLS_GENERAL> (const EXPRROW &other, double norm1, double norm2) const;
@@ -0,0 +1,253 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file vect_kendall.cpp
+    Functions for calculating the Kendall rank correlation
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <vector>
+#include <algorithm>  //  sort, stable_sort
+
+#include <cstdint>  //  uint64_t
+#include <climits>  //  UINT_MAX
+#include <cmath>  //  sqrt
+
+using namespace std;
+
+#include "global_defn.hpp"
+#include "expr_row.hpp"
+#include "vect_kendall.hpp"
+
+
+//!  Compare two columns of a row by their expression levels
+class KENDALLLESS {
+  public:
+    //!  Constructor that takes the row
+    KENDALLLESS (const EXPRROW &arg1)
+      : row (arg1)
+    {
+    }
+
+    //!  Whether or not column a has a lower expression level than column b
+    bool operator() (unsigned int a, unsigned int b) const {
+      return (row.getExpr (a) < row.getExpr (b));
+    }
+
+  private:
+    //!  The row being sorted
+    const EXPRROW &row;
+};
+
+
+//!  Count the pairs within the runs of equal values in a sorted array
+static uint64_t countTies (const unsigned int *values, unsigned int n) {
+  uint64_t ties = 0;
+  unsigned int i = 0;
+  unsigned int j = 0;
+
+  while (i < n) {
+    for (j = i + 1; (j < n) && (values[j] == values[i]); j++) {
+    }
+    ties += static_cast<uint64_t> (j - i) * (j - i - 1) / 2;
+    i = j;
+  }
+
+  return ties;
+}
+
+
+//!  Sort an array using a bottom-up merge sort, counting the swaps
+/*!
+     \param values The array to sort
+     \param temp Scratch space of the same size
+     \param n The number of values
+     \return The number of swaps (inversions), i.e., pairs that were out of order
+*/
+static uint64_t countSwaps (unsigned int *values, unsigned int *temp, unsigned int n) {
+  uint64_t swaps = 0;
+  unsigned int width = 1;
+  unsigned int *from = values;
+  unsigned int *to = temp;
+
+  for (width = 1; width < n; width *= 2) {
+    for (unsigned int lo = 0; lo < n; lo += 2 * width) {
+      unsigned int mid = min (lo + width, n);
+      unsigned int hi = min (lo + 2 * width, n);
+      unsigned int a = lo;
+      unsigned int b = mid;
+      unsigned int k = lo;
+
+      while ((a < mid) && (b < hi)) {
+        if (from[b] < from[a]) {
+          //  Every value left in the first half is out of order with this one
+          swaps += mid - a;
+          to[k++] = from[b++];
+        }
+        else {
+          to[k++] = from[a++];
+        }
+      }
+      while (a < mid) {
+        to[k++] = from[a++];
+      }
+      while (b < hi) {
+        to[k++] = from[b++];
+      }
+    }
+    swap (from, to);
+  }
+
+  if (from != values) {
+    copy (from, from + n, values);
+  }
+
+  return swaps;
+}
+
+
+//!  Sort the non-null columns of a row and assign them dense ranks
+/*!
+     \param row The row of expression levels
+     \param order Filled with the non-null columns, sorted by expression level
+     \param ranks Filled with the rank of each column; equal expression levels get equal ranks and NULLs get KENDALL_NULL_RANK
+     \return The number of non-null columns
+
+     Both arrays must have room for as many entries as the row has columns.
+*/
+unsigned int presortKendall (const EXPRROW &row, unsigned int *order, unsigned int *ranks) {
+  unsigned int n = row.getN ();
+  unsigned int count = 0;
+  unsigned int i = 0;
+  unsigned int rank = 0;
+
+  for (i = 0; i < n; i++) {
+    ranks[i] = KENDALL_NULL_RANK;
+    if (!row.isNull (i)) {
+      order[count] = i;
+      count++;
+    }
+  }
+
+  //  Ties are kept in column order so that the result does not depend on the sort
+  stable_sort (order, order + count, KENDALLLESS (row));
+
+  for (i = 0; i < count; i++) {
+    if ((i > 0) && (row.getExpr (order[i]) != row.getExpr (order[i - 1]))) {
+      rank++;
+    }
+    ranks[order[i]] = rank;
+  }
+
+  return count;
+}
+
+
+//!  The Kendall rank correlation (distance) between two presorted rows
+/*!
+     \param x_order The non-null columns of the first row, sorted (see presortKendall ())
+     \param x_count The number of non-null columns of the first row
+     \param x_ranks The ranks of the columns of the first row
+     \param y_ranks The ranks of the columns of the second row
+     \return 1 - tau-b, or 2 (the maximum distance) if either row has no variation
+
+     Only the columns that are non-null in both rows are used.  Walking
+     through the first row's order gives the pairs sorted by x; ties in x
+     are then sorted by y, and the swaps made by a merge sort of the y
+     ranks give the number of discordant pairs.  With n0 pairs in total,
+     n1 and n2 pairs tied in x and in y, and n3 pairs tied in both:
+
+       tau-b = (n0 - n1 - n2 + n3 - 2 swaps) / sqrt ((n0 - n1) (n0 - n2))
+*/
+double distKendall (const unsigned int *x_order, unsigned int x_count, const unsigned int *x_ranks, const unsigned int *y_ranks) {
+  vector<unsigned int> xs;
+  vector<unsigned int> ys;
+  unsigned int n = 0;
+  unsigned int i = 0;
+  unsigned int j = 0;
+  uint64_t n1 = 0;
+  uint64_t n3 = 0;
+
+  xs.reserve (x_count);
+  ys.reserve (x_count);
+  for (i = 0; i < x_count; i++) {
+    unsigned int col = x_order[i];
+    if (y_ranks[col] != KENDALL_NULL_RANK) {
+      xs.push_back (x_ranks[col]);
+      ys.push_back (y_ranks[col]);
+    }
+  }
+  n = xs.size ();
+  if (n < 2) {
+    return 2.0;
+  }
+
+  //  Pairs tied in x, and in both x and y
+  i = 0;
+  while (i < n) {
+    for (j = i + 1; (j < n) && (xs[j] == xs[i]); j++) {
+    }
+    if (j - i > 1) {
+      n1 += static_cast<uint64_t> (j - i) * (j - i - 1) / 2;
+      sort (ys.begin () + i, ys.begin () + j);
+      n3 += countTies (&ys[i], j - i);
+    }
+    i = j;
+  }
+
+  //  Discordant pairs, then pairs tied in y
+  vector<unsigned int> temp (n);
+  uint64_t swaps = countSwaps (&ys[0], &temp[0], n);
+  uint64_t n2 = countTies (&ys[0], n);
+
+  uint64_t n0 = static_cast<uint64_t> (n) * (n - 1) / 2;
+  if ((n1 == n0) || (n2 == n0)) {
+    return 2.0;
+  }
+
+  double numer = static_cast<double> (n0) - n1 - n2 + n3 - 2.0 * swaps;
+  double denom = sqrt (static_cast<double> (n0 - n1) * static_cast<double> (n0 - n2));
+
+  return (1 - (numer / denom));
+}
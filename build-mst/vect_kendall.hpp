@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file vect_kendall.hpp
+    Header file for the Kendall rank correlation functions
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#ifndef VECT_KENDALL_HPP
+#define VECT_KENDALL_HPP
+
+/*!
+     The Kendall rank correlation (tau-b) is calculated using Knight's
+     algorithm, which counts the discordant pairs as the number of swaps
+     made by a merge sort.  This takes O(n log n) time per pair instead
+     of O(n^2).
+
+     Most of the work is in sorting each row by its expression levels,
+     which does not depend on the other row in the pair.  So, each row is
+     presorted once by presortKendall () and the result is reused by
+     distKendall () for every partner of the row.  NULLs are handled
+     pairwise:  columns which are NULL in the other row are simply skipped
+     when walking through the presorted order.
+*/
+
+//  Sort the non-null columns of a row and assign them dense ranks  [vect_kendall.cpp]
+unsigned int presortKendall (const EXPRROW &row, unsigned int *order, unsigned int *ranks);
+
+//  The Kendall rank correlation (distance) between two presorted rows  [vect_kendall.cpp]
+double distKendall (const unsigned int *x_order, unsigned int x_count, const unsigned int *x_ranks, const unsigned int *y_ranks);
+
+#endif
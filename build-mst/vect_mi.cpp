@@ -0,0 +1,210 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file vect_mi.cpp
+    Functions for calculating the mutual information
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <vector>
+#include <algorithm>  //  sort, lower_bound, min
+
+#include <cstdint>  //  uint8_t, uint32_t, uint64_t
+#include <cmath>  //  log, sqrt
+
+using namespace std;
+
+#include "global_defn.hpp"
+#include "expr_row.hpp"
+#include "vect_mi.hpp"
+
+
+//!  Discretise the non-null columns of a row into bin codes
+/*!
+     \param row The row of expression levels
+     \param codes Filled with the bin of each column (0 to MI_BINS - 1), or MI_NULL_CODE for NULLs
+
+     The bins are equal-frequency:  a column's bin is based on the number
+     of non-null expression levels below it, so equal expression levels
+     always share a bin and outliers do not squeeze the rest of the row
+     into a few bins.
+*/
+void binMutualInfo (const EXPRROW &row, uint8_t *codes) {
+  unsigned int n = row.getN ();
+  unsigned int i = 0;
+  vector<double> sorted;
+
+  for (i = 0; i < n; i++) {
+    if (!row.isNull (i)) {
+      sorted.push_back (row.getExpr (i));
+    }
+  }
+  sort (sorted.begin (), sorted.end ());
+
+  uint64_t count = sorted.size ();
+  for (i = 0; i < n; i++) {
+    if (row.isNull (i)) {
+      codes[i] = MI_NULL_CODE;
+    }
+    else {
+      uint64_t below = lower_bound (sorted.begin (), sorted.end (), row.getExpr (i)) - sorted.begin ();
+      codes[i] = static_cast<uint8_t> ((below * MI_BINS) / count);
+    }
+  }
+
+  return;
+}
+
+
+//!  Count the joint bin codes of two rows
+/*!
+     \param x The bin codes of the first row
+     \param y The bin codes of the second row
+     \param n The number of columns
+     \param hist Filled with the count of each joint code (x << 4 | y); 256 entries
+
+     The joint codes are formed a chunk of MI_CHUNK_COLUMNS columns at a
+     time in a loop that the compiler vectorises.  They are then counted
+     into four histograms in turn so that consecutive increments to the
+     same cell do not wait on each other.
+*/
+static void countJoint (const uint8_t *x, const uint8_t *y, unsigned int n, uint32_t *hist) {
+  uint8_t joint[MI_CHUNK_COLUMNS];
+  uint32_t part[4][256];
+  unsigned int i = 0;
+  unsigned int k = 0;
+
+  for (k = 0; k < 256; k++) {
+    part[0][k] = 0;
+    part[1][k] = 0;
+    part[2][k] = 0;
+    part[3][k] = 0;
+  }
+
+  for (i = 0; i < n; i += MI_CHUNK_COLUMNS) {
+    unsigned int size = min (n - i, static_cast<unsigned int> (MI_CHUNK_COLUMNS));
+    for (k = 0; k < size; k++) {
+      joint[k] = static_cast<uint8_t> ((x[i + k] << 4) | y[i + k]);
+    }
+    for (k = 0; k + 4 <= size; k += 4) {
+      part[0][joint[k]]++;
+      part[1][joint[k + 1]]++;
+      part[2][joint[k + 2]]++;
+      part[3][joint[k + 3]]++;
+    }
+    for (; k < size; k++) {
+      part[0][joint[k]]++;
+    }
+  }
+
+  for (k = 0; k < 256; k++) {
+    hist[k] = part[0][k] + part[1][k] + part[2][k] + part[3][k];
+  }
+
+  return;
+}
+
+
+//!  The mutual information (distance) between two discretised rows
+/*!
+     \param x The bin codes of the first row (see binMutualInfo ())
+     \param y The bin codes of the second row
+     \param n The number of columns
+     \return 1 - I (X; Y) / sqrt (H (X) H (Y)), or 1 (the maximum distance) if either row is constant
+
+     Only the columns that are non-null in both rows are counted; the
+     entropies are taken over the same columns.
+*/
+double distMutualInfo (const uint8_t *x, const uint8_t *y, unsigned int n) {
+  uint32_t hist[256];
+  double cx[MI_BINS];
+  double cy[MI_BINS];
+  double total = 0;
+  double sum_xy = 0;
+  double sum_x = 0;
+  double sum_y = 0;
+  unsigned int a = 0;
+  unsigned int b = 0;
+
+  countJoint (x, y, n, hist);
+
+  for (a = 0; a < MI_BINS; a++) {
+    cx[a] = 0;
+    cy[a] = 0;
+  }
+  for (a = 0; a < MI_BINS; a++) {
+    for (b = 0; b < MI_BINS; b++) {
+      double c = hist[(a << 4) | b];
+      if (c > 0) {
+        sum_xy += c * log (c);
+        cx[a] += c;
+        cy[b] += c;
+        total += c;
+      }
+    }
+  }
+  if (total == 0) {
+    return 1.0;
+  }
+  for (a = 0; a < MI_BINS; a++) {
+    if (cx[a] > 0) {
+      sum_x += cx[a] * log (cx[a]);
+    }
+    if (cy[a] > 0) {
+      sum_y += cy[a] * log (cy[a]);
+    }
+  }
+
+  //  Entropies from the counts:  H = log (total) - sum (c log c) / total
+  double h_x = log (total) - sum_x / total;
+  double h_y = log (total) - sum_y / total;
+  double h_xy = log (total) - sum_xy / total;
+  if ((h_x <= 0) || (h_y <= 0)) {
+    return 1.0;
+  }
+
+  double nmi = (h_x + h_y - h_xy) / sqrt (h_x * h_y);
+
+  return (1 - min (max (nmi, 0.0), 1.0));
+}
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file vect_mi.hpp
+    Header file for the mutual information functions
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#ifndef VECT_MI_HPP
+#define VECT_MI_HPP
+
+/*!
+     The mutual information between two rows is estimated from a joint
+     histogram of their expression levels.  Each row is discretised once
+     into MI_BINS equal-frequency bins by binMutualInfo (), with one byte
+     per column, so that filling the histogram for a pair only involves
+     counting pairs of small integers.  NULLs are given MI_NULL_CODE and
+     are handled pairwise by leaving out the histogram cells they fall into.
+
+     The distance is 1 minus the normalised mutual information,
+     I (X; Y) / sqrt (H (X) H (Y)), so its range is [0, 1].
+*/
+
+//  Discretise the non-null columns of a row into bin codes  [vect_mi.cpp]
+void binMutualInfo (const EXPRROW &row, uint8_t *codes);
+
+//  The mutual information (distance) between two discretised rows  [vect_mi.cpp]
+double distMutualInfo (const uint8_t *x, const uint8_t *y, unsigned int n);
+
+#endif
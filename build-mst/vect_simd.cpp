@@ -0,0 +1,1063 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file vect_simd.cpp
+    Distance kernels for pairs of rows, with one version per instruction set
+      (NOT a class)
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <cstdint>  //  uint64_t
+#include <cmath>  //  fabs
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define HAVE_X86_SIMD 0
+#endif
+
+using namespace std;
+
+#include "global_defn.hpp"
+#include "vect_simd.hpp"
+
+/*!
+     Every kernel keeps SIMD_LANES partial sums; lane l accumulates the
+     columns l, l + SIMD_LANES, l + 2 * SIMD_LANES, and so on, in order.
+     The SSE2, AVX2 and AVX-512 versions hold these lanes in 4, 2 and 1
+     registers respectively, so all of them (and the portable version)
+     add up the same values in the same order and return identical sums.
+
+     Columns which are NULL in either row are zeroed in both rows before
+     the arithmetic, so that they add exactly 0 to every partial sum.
+     The kernels are specialised by the NULL profile of the rows:  with
+     NULLS_NONE, the NULL bitmaps are not read; with NULLS_SPARSE, only the
+     blocks which have NULLs are masked (except for AVX-512, where masking
+     is free); and with NULLS_GENERAL, every block is masked.  Since
+     masking a block without NULLs changes nothing, all three give the
+     same sums.
+     Rows are padded with zeroes to a multiple of SIMD_LANES and the
+     padding is flagged as NULL.
+
+     This file should be compiled with floating-point contraction turned
+     off; otherwise, the AVX-512 versions may use fused multiply-adds and
+     round differently from the others.
+*/
+
+//!  The instruction set in use; chosen when the program starts
+static SIMD_LEVEL simd_level = detectSIMDLevel ();
+
+
+//!  Find the best instruction set supported by this processor
+SIMD_LEVEL detectSIMDLevel () {
+#if HAVE_X86_SIMD
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx512f")) {
+    return SIMD_AVX512;
+  }
+  if (__builtin_cpu_supports ("avx2")) {
+    return SIMD_AVX2;
+  }
+  if (__builtin_cpu_supports ("sse2")) {
+    return SIMD_SSE2;
+  }
+#endif
+  return SIMD_SCALAR;
+}
+
+//!  Set the instruction set; it is lowered to the best one this processor supports
+void setSIMDLevel (SIMD_LEVEL arg) {
+  SIMD_LEVEL best = detectSIMDLevel ();
+
+  simd_level = (arg > best) ? best : arg;
+}
+
+//!  Get the instruction set in use
+SIMD_LEVEL getSIMDLevel () {
+  return simd_level;
+}
+
+
+//!  Count the columns where neither row is NULL
+/*!
+     \param xn NULL bitmap of the first row
+     \param yn NULL bitmap of the second row
+     \param words Number of words in each bitmap
+*/
+unsigned int countNonNull (const uint64_t *xn, const uint64_t *yn, unsigned int words) {
+  unsigned int count = 0;
+
+  for (unsigned int i = 0; i < words; i++) {
+    count += __builtin_popcountll (~(xn[i] | yn[i]));
+  }
+
+  return count;
+}
+
+//!  Add up the SIMD_LANES partial sums of a kernel in a fixed order
+double sumLanes (const double *lanes) {
+  return (((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7])));
+}
+
+//!  Get the flags of the columns in a block where neither row is NULL (bit l is set if lane l is valid)
+static inline unsigned int validLanes (const uint64_t *xn, const uint64_t *yn, unsigned int block) {
+  unsigned int word = block / (NULL_WORD_BITS / SIMD_LANES);
+  unsigned int shift = (block % (NULL_WORD_BITS / SIMD_LANES)) * SIMD_LANES;
+
+  return static_cast<unsigned int> ((~(xn[word] | yn[word]) >> shift) & 0xFF);
+}
+
+
+////////////////////////////////////////
+//  Portable versions
+
+template <NULL_PROFILE P>
+static void sumSqDiffScalar (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+
+  for (unsigned int l = 0; l < SIMD_LANES; l++) {
+    lanes[l] = 0.0;
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    unsigned int valid = (P == NULLS_NONE) ? 0xFF : validLanes (xn, yn, b);
+    for (unsigned int l = 0; l < SIMD_LANES; l++) {
+      if ((valid >> l) & 1) {
+        double temp = x[b * SIMD_LANES + l] - y[b * SIMD_LANES + l];
+        lanes[l] += temp * temp;
+      }
+    }
+  }
+}
+
+template <NULL_PROFILE P>
+static void sumAbsDiffScalar (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+
+  for (unsigned int l = 0; l < SIMD_LANES; l++) {
+    lanes[l] = 0.0;
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    unsigned int valid = (P == NULLS_NONE) ? 0xFF : validLanes (xn, yn, b);
+    for (unsigned int l = 0; l < SIMD_LANES; l++) {
+      if ((valid >> l) & 1) {
+        lanes[l] += fabs (x[b * SIMD_LANES + l] - y[b * SIMD_LANES + l]);
+      }
+    }
+  }
+}
+
+template <NULL_PROFILE P>
+static void sumPearsonScalar (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+
+  for (unsigned int l = 0; l < 5 * SIMD_LANES; l++) {
+    lanes[l] = 0.0;
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    unsigned int valid = (P == NULLS_NONE) ? 0xFF : validLanes (xn, yn, b);
+    for (unsigned int l = 0; l < SIMD_LANES; l++) {
+      if ((valid >> l) & 1) {
+        double xv = x[b * SIMD_LANES + l];
+        double yv = y[b * SIMD_LANES + l];
+        lanes[l] += xv * yv;
+        lanes[SIMD_LANES + l] += xv;
+        lanes[2 * SIMD_LANES + l] += yv;
+        lanes[3 * SIMD_LANES + l] += xv * xv;
+        lanes[4 * SIMD_LANES + l] += yv * yv;
+      }
+    }
+  }
+}
+
+template <NULL_PROFILE P>
+static void sumDotScalar (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+
+  for (unsigned int l = 0; l < SIMD_LANES; l++) {
+    lanes[l] = 0.0;
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    unsigned int valid = (P == NULLS_NONE) ? 0xFF : validLanes (xn, yn, b);
+    for (unsigned int l = 0; l < SIMD_LANES; l++) {
+      if ((valid >> l) & 1) {
+        lanes[l] += x[b * SIMD_LANES + l] * y[b * SIMD_LANES + l];
+      }
+    }
+  }
+}
+
+template <NULL_PROFILE P>
+static void sumUncenteredScalar (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+
+  for (unsigned int l = 0; l < 3 * SIMD_LANES; l++) {
+    lanes[l] = 0.0;
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    unsigned int valid = (P == NULLS_NONE) ? 0xFF : validLanes (xn, yn, b);
+    for (unsigned int l = 0; l < SIMD_LANES; l++) {
+      if ((valid >> l) & 1) {
+        double xv = x[b * SIMD_LANES + l];
+        double yv = y[b * SIMD_LANES + l];
+        lanes[l] += xv * yv;
+        lanes[SIMD_LANES + l] += xv * xv;
+        lanes[2 * SIMD_LANES + l] += yv * yv;
+      }
+    }
+  }
+}
+
+//!  Dot products between DOT_BLOCK_ROWS rows of x and DOT_BLOCK_ROWS rows of y; no NULLs allowed
+/*!
+     This version is also used for SSE2, since the compiler already makes
+     use of SSE2 on x86-64 and there are too few registers to do better.
+*/
+static void dotBlockScalar (const double *const *x, const double *const *y, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+
+  for (unsigned int l = 0; l < DOT_BLOCK_ROWS * DOT_BLOCK_ROWS * SIMD_LANES; l++) {
+    lanes[l] = 0.0;
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    for (unsigned int r = 0; r < DOT_BLOCK_ROWS; r++) {
+      for (unsigned int c = 0; c < DOT_BLOCK_ROWS; c++) {
+        double *acc = lanes + (r * DOT_BLOCK_ROWS + c) * SIMD_LANES;
+        for (unsigned int l = 0; l < SIMD_LANES; l++) {
+          acc[l] += x[r][b * SIMD_LANES + l] * y[c][b * SIMD_LANES + l];
+        }
+      }
+    }
+  }
+}
+
+
+//!  Dot product of two rows quantized to 8 bits; the sum is exact
+static int64_t dotQuant8Scalar (const int8_t *x, const int8_t *y, unsigned int n) {
+  int64_t sum = 0;
+
+  for (unsigned int i = 0; i < n; i++) {
+    sum += static_cast<int32_t> (x[i]) * y[i];
+  }
+
+  return sum;
+}
+
+//!  Dot product of two rows quantized to 16 bits; the sum is exact
+static int64_t dotQuant16Scalar (const int16_t *x, const int16_t *y, unsigned int n) {
+  int64_t sum = 0;
+
+  for (unsigned int i = 0; i < n; i++) {
+    sum += static_cast<int32_t> (x[i]) * y[i];
+  }
+
+  return sum;
+}
+
+
+#if HAVE_X86_SIMD
+////////////////////////////////////////
+//  SSE2 versions; lanes (2k, 2k + 1) are in register k
+
+#define SSE2_FN __attribute__ ((target ("sse2")))
+
+//!  Expand the valid flags of lanes (2k, 2k + 1) into a mask of all ones or zeroes per lane
+SSE2_FN static inline __m128d maskSSE2 (__m128i valid, unsigned int k) {
+  __m128i bits = _mm_set_epi32 (2 << (2 * k), 2 << (2 * k), 1 << (2 * k), 1 << (2 * k));
+
+  return _mm_castsi128_pd (_mm_cmpeq_epi32 (_mm_and_si128 (valid, bits), bits));
+}
+
+//!  Load a block of columns from both rows, with the columns where either row is NULL set to zero
+/*!
+     No masking is done for rows without NULLs; for rows with sparse NULLs,
+     it is only done for the blocks that actually have NULLs.
+*/
+template <NULL_PROFILE P>
+SSE2_FN static inline void loadSSE2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int b, __m128d *xv, __m128d *yv) {
+  unsigned int valid = (P == NULLS_NONE) ? 0xFF : validLanes (xn, yn, b);
+
+  for (unsigned int k = 0; k < 4; k++) {
+    xv[k] = _mm_loadu_pd (x + b * SIMD_LANES + 2 * k);
+    yv[k] = _mm_loadu_pd (y + b * SIMD_LANES + 2 * k);
+  }
+  if ((P == NULLS_GENERAL) || ((P == NULLS_SPARSE) && (valid != 0xFF))) {
+    __m128i bits = _mm_set1_epi32 (valid);
+    for (unsigned int k = 0; k < 4; k++) {
+      __m128d mask = maskSSE2 (bits, k);
+      xv[k] = _mm_and_pd (xv[k], mask);
+      yv[k] = _mm_and_pd (yv[k], mask);
+    }
+  }
+}
+
+template <NULL_PROFILE P>
+SSE2_FN static void sumSqDiffSSE2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m128d acc[4];
+
+  for (unsigned int k = 0; k < 4; k++) {
+    acc[k] = _mm_setzero_pd ();
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m128d xb[4];
+    __m128d yb[4];
+    loadSSE2<P> (x, xn, y, yn, b, xb, yb);
+    for (unsigned int k = 0; k < 4; k++) {
+      __m128d xv = xb[k];
+      __m128d yv = yb[k];
+      __m128d temp = _mm_sub_pd (xv, yv);
+      acc[k] = _mm_add_pd (acc[k], _mm_mul_pd (temp, temp));
+    }
+  }
+  for (unsigned int k = 0; k < 4; k++) {
+    _mm_storeu_pd (lanes + 2 * k, acc[k]);
+  }
+}
+
+template <NULL_PROFILE P>
+SSE2_FN static void sumAbsDiffSSE2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m128d sign = _mm_set1_pd (-0.0);
+  __m128d acc[4];
+
+  for (unsigned int k = 0; k < 4; k++) {
+    acc[k] = _mm_setzero_pd ();
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m128d xb[4];
+    __m128d yb[4];
+    loadSSE2<P> (x, xn, y, yn, b, xb, yb);
+    for (unsigned int k = 0; k < 4; k++) {
+      __m128d xv = xb[k];
+      __m128d yv = yb[k];
+      acc[k] = _mm_add_pd (acc[k], _mm_andnot_pd (sign, _mm_sub_pd (xv, yv)));
+    }
+  }
+  for (unsigned int k = 0; k < 4; k++) {
+    _mm_storeu_pd (lanes + 2 * k, acc[k]);
+  }
+}
+
+template <NULL_PROFILE P>
+SSE2_FN static void sumPearsonSSE2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m128d acc[5][4];
+
+  for (unsigned int s = 0; s < 5; s++) {
+    for (unsigned int k = 0; k < 4; k++) {
+      acc[s][k] = _mm_setzero_pd ();
+    }
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m128d xb[4];
+    __m128d yb[4];
+    loadSSE2<P> (x, xn, y, yn, b, xb, yb);
+    for (unsigned int k = 0; k < 4; k++) {
+      __m128d xv = xb[k];
+      __m128d yv = yb[k];
+      acc[0][k] = _mm_add_pd (acc[0][k], _mm_mul_pd (xv, yv));
+      acc[1][k] = _mm_add_pd (acc[1][k], xv);
+      acc[2][k] = _mm_add_pd (acc[2][k], yv);
+      acc[3][k] = _mm_add_pd (acc[3][k], _mm_mul_pd (xv, xv));
+      acc[4][k] = _mm_add_pd (acc[4][k], _mm_mul_pd (yv, yv));
+    }
+  }
+  for (unsigned int s = 0; s < 5; s++) {
+    for (unsigned int k = 0; k < 4; k++) {
+      _mm_storeu_pd (lanes + s * SIMD_LANES + 2 * k, acc[s][k]);
+    }
+  }
+}
+
+template <NULL_PROFILE P>
+SSE2_FN static void sumDotSSE2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m128d acc[4];
+
+  for (unsigned int k = 0; k < 4; k++) {
+    acc[k] = _mm_setzero_pd ();
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m128d xb[4];
+    __m128d yb[4];
+    loadSSE2<P> (x, xn, y, yn, b, xb, yb);
+    for (unsigned int k = 0; k < 4; k++) {
+      acc[k] = _mm_add_pd (acc[k], _mm_mul_pd (xb[k], yb[k]));
+    }
+  }
+  for (unsigned int k = 0; k < 4; k++) {
+    _mm_storeu_pd (lanes + 2 * k, acc[k]);
+  }
+}
+
+template <NULL_PROFILE P>
+SSE2_FN static void sumUncenteredSSE2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m128d acc[3][4];
+
+  for (unsigned int s = 0; s < 3; s++) {
+    for (unsigned int k = 0; k < 4; k++) {
+      acc[s][k] = _mm_setzero_pd ();
+    }
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m128d xb[4];
+    __m128d yb[4];
+    loadSSE2<P> (x, xn, y, yn, b, xb, yb);
+    for (unsigned int k = 0; k < 4; k++) {
+      __m128d xv = xb[k];
+      __m128d yv = yb[k];
+      acc[0][k] = _mm_add_pd (acc[0][k], _mm_mul_pd (xv, yv));
+      acc[1][k] = _mm_add_pd (acc[1][k], _mm_mul_pd (xv, xv));
+      acc[2][k] = _mm_add_pd (acc[2][k], _mm_mul_pd (yv, yv));
+    }
+  }
+  for (unsigned int s = 0; s < 3; s++) {
+    for (unsigned int k = 0; k < 4; k++) {
+      _mm_storeu_pd (lanes + s * SIMD_LANES + 2 * k, acc[s][k]);
+    }
+  }
+}
+
+
+////////////////////////////////////////
+//  AVX2 versions; lanes 0-3 and 4-7 are in registers 0 and 1
+
+#define AVX2_FN __attribute__ ((target ("avx2")))
+
+//!  Expand the valid flags of lanes (4k, ..., 4k + 3) into a mask of all ones or zeroes per lane
+AVX2_FN static inline __m256d maskAVX2 (__m256i valid, unsigned int k) {
+  __m256i bits = _mm256_set_epi64x (8 << (4 * k), 4 << (4 * k), 2 << (4 * k), 1 << (4 * k));
+
+  return _mm256_castsi256_pd (_mm256_cmpeq_epi64 (_mm256_and_si256 (valid, bits), bits));
+}
+
+//!  Load a block of columns from both rows; see loadSSE2 ()
+template <NULL_PROFILE P>
+AVX2_FN static inline void loadAVX2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int b, __m256d *xv, __m256d *yv) {
+  unsigned int valid = (P == NULLS_NONE) ? 0xFF : validLanes (xn, yn, b);
+
+  for (unsigned int k = 0; k < 2; k++) {
+    xv[k] = _mm256_loadu_pd (x + b * SIMD_LANES + 4 * k);
+    yv[k] = _mm256_loadu_pd (y + b * SIMD_LANES + 4 * k);
+  }
+  if ((P == NULLS_GENERAL) || ((P == NULLS_SPARSE) && (valid != 0xFF))) {
+    __m256i bits = _mm256_set1_epi64x (valid);
+    for (unsigned int k = 0; k < 2; k++) {
+      __m256d mask = maskAVX2 (bits, k);
+      xv[k] = _mm256_and_pd (xv[k], mask);
+      yv[k] = _mm256_and_pd (yv[k], mask);
+    }
+  }
+}
+
+template <NULL_PROFILE P>
+AVX2_FN static void sumSqDiffAVX2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m256d acc[2];
+
+  for (unsigned int k = 0; k < 2; k++) {
+    acc[k] = _mm256_setzero_pd ();
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m256d xb[2];
+    __m256d yb[2];
+    loadAVX2<P> (x, xn, y, yn, b, xb, yb);
+    for (unsigned int k = 0; k < 2; k++) {
+      __m256d xv = xb[k];
+      __m256d yv = yb[k];
+      __m256d temp = _mm256_sub_pd (xv, yv);
+      acc[k] = _mm256_add_pd (acc[k], _mm256_mul_pd (temp, temp));
+    }
+  }
+  for (unsigned int k = 0; k < 2; k++) {
+    _mm256_storeu_pd (lanes + 4 * k, acc[k]);
+  }
+}
+
+template <NULL_PROFILE P>
+AVX2_FN static void sumAbsDiffAVX2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m256d sign = _mm256_set1_pd (-0.0);
+  __m256d acc[2];
+
+  for (unsigned int k = 0; k < 2; k++) {
+    acc[k] = _mm256_setzero_pd ();
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m256d xb[2];
+    __m256d yb[2];
+    loadAVX2<P> (x, xn, y, yn, b, xb, yb);
+    for (unsigned int k = 0; k < 2; k++) {
+      __m256d xv = xb[k];
+      __m256d yv = yb[k];
+      acc[k] = _mm256_add_pd (acc[k], _mm256_andnot_pd (sign, _mm256_sub_pd (xv, yv)));
+    }
+  }
+  for (unsigned int k = 0; k < 2; k++) {
+    _mm256_storeu_pd (lanes + 4 * k, acc[k]);
+  }
+}
+
+template <NULL_PROFILE P>
+AVX2_FN static void sumPearsonAVX2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m256d acc[5][2];
+
+  for (unsigned int s = 0; s < 5; s++) {
+    for (unsigned int k = 0; k < 2; k++) {
+      acc[s][k] = _mm256_setzero_pd ();
+    }
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m256d xb[2];
+    __m256d yb[2];
+    loadAVX2<P> (x, xn, y, yn, b, xb, yb);
+    for (unsigned int k = 0; k < 2; k++) {
+      __m256d xv = xb[k];
+      __m256d yv = yb[k];
+      acc[0][k] = _mm256_add_pd (acc[0][k], _mm256_mul_pd (xv, yv));
+      acc[1][k] = _mm256_add_pd (acc[1][k], xv);
+      acc[2][k] = _mm256_add_pd (acc[2][k], yv);
+      acc[3][k] = _mm256_add_pd (acc[3][k], _mm256_mul_pd (xv, xv));
+      acc[4][k] = _mm256_add_pd (acc[4][k], _mm256_mul_pd (yv, yv));
+    }
+  }
+  for (unsigned int s = 0; s < 5; s++) {
+    for (unsigned int k = 0; k < 2; k++) {
+      _mm256_storeu_pd (lanes + s * SIMD_LANES + 4 * k, acc[s][k]);
+    }
+  }
+}
+
+template <NULL_PROFILE P>
+AVX2_FN static void sumDotAVX2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m256d acc[2];
+
+  for (unsigned int k = 0; k < 2; k++) {
+    acc[k] = _mm256_setzero_pd ();
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m256d xb[2];
+    __m256d yb[2];
+    loadAVX2<P> (x, xn, y, yn, b, xb, yb);
+    for (unsigned int k = 0; k < 2; k++) {
+      acc[k] = _mm256_add_pd (acc[k], _mm256_mul_pd (xb[k], yb[k]));
+    }
+  }
+  for (unsigned int k = 0; k < 2; k++) {
+    _mm256_storeu_pd (lanes + 4 * k, acc[k]);
+  }
+}
+
+template <NULL_PROFILE P>
+AVX2_FN static void sumUncenteredAVX2 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m256d acc[3][2];
+
+  for (unsigned int s = 0; s < 3; s++) {
+    for (unsigned int k = 0; k < 2; k++) {
+      acc[s][k] = _mm256_setzero_pd ();
+    }
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m256d xb[2];
+    __m256d yb[2];
+    loadAVX2<P> (x, xn, y, yn, b, xb, yb);
+    for (unsigned int k = 0; k < 2; k++) {
+      __m256d xv = xb[k];
+      __m256d yv = yb[k];
+      acc[0][k] = _mm256_add_pd (acc[0][k], _mm256_mul_pd (xv, yv));
+      acc[1][k] = _mm256_add_pd (acc[1][k], _mm256_mul_pd (xv, xv));
+      acc[2][k] = _mm256_add_pd (acc[2][k], _mm256_mul_pd (yv, yv));
+    }
+  }
+  for (unsigned int s = 0; s < 3; s++) {
+    for (unsigned int k = 0; k < 2; k++) {
+      _mm256_storeu_pd (lanes + s * SIMD_LANES + 4 * k, acc[s][k]);
+    }
+  }
+}
+
+//!  Dot products of a block of rows; done as (4 x 2) pairs for each half of the lanes to fit in 16 registers
+AVX2_FN static void dotBlockAVX2 (const double *const *x, const double *const *y, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m256d acc[DOT_BLOCK_ROWS][2];
+
+  for (unsigned int c0 = 0; c0 < DOT_BLOCK_ROWS; c0 += 2) {
+    for (unsigned int k = 0; k < 2; k++) {
+      for (unsigned int r = 0; r < DOT_BLOCK_ROWS; r++) {
+        acc[r][0] = _mm256_setzero_pd ();
+        acc[r][1] = _mm256_setzero_pd ();
+      }
+      for (unsigned int b = 0; b < blocks; b++) {
+        unsigned int offset = b * SIMD_LANES + 4 * k;
+        __m256d y0 = _mm256_loadu_pd (y[c0] + offset);
+        __m256d y1 = _mm256_loadu_pd (y[c0 + 1] + offset);
+        for (unsigned int r = 0; r < DOT_BLOCK_ROWS; r++) {
+          __m256d xv = _mm256_loadu_pd (x[r] + offset);
+          acc[r][0] = _mm256_add_pd (acc[r][0], _mm256_mul_pd (xv, y0));
+          acc[r][1] = _mm256_add_pd (acc[r][1], _mm256_mul_pd (xv, y1));
+        }
+      }
+      for (unsigned int r = 0; r < DOT_BLOCK_ROWS; r++) {
+        _mm256_storeu_pd (lanes + (r * DOT_BLOCK_ROWS + c0) * SIMD_LANES + 4 * k, acc[r][0]);
+        _mm256_storeu_pd (lanes + (r * DOT_BLOCK_ROWS + c0 + 1) * SIMD_LANES + 4 * k, acc[r][1]);
+      }
+    }
+  }
+}
+
+//!  Dot product of two rows quantized to 8 bits
+/*!
+     Each block of QUANT_BLOCK_COLUMNS columns is widened to 16 bits and
+     multiplied and added in pairs into eight 32-bit lanes.  Each product
+     is at most 127 * 127 in magnitude, so the lanes are added into a
+     64-bit sum every QUANT8_FLUSH_BLOCKS blocks, before they can overflow.
+*/
+AVX2_FN static int64_t dotQuant8AVX2 (const int8_t *x, const int8_t *y, unsigned int n) {
+  unsigned int blocks = n / QUANT_BLOCK_COLUMNS;
+  int64_t sum = 0;
+  int32_t lanes[8];
+
+  for (unsigned int first = 0; first < blocks; first += QUANT8_FLUSH_BLOCKS) {
+    unsigned int last = (blocks - first > QUANT8_FLUSH_BLOCKS) ? first + QUANT8_FLUSH_BLOCKS : blocks;
+    __m256i acc = _mm256_setzero_si256 ();
+    for (unsigned int b = first; b < last; b++) {
+      __m256i xv = _mm256_cvtepi8_epi16 (_mm_loadu_si128 (reinterpret_cast<const __m128i *> (x + b * QUANT_BLOCK_COLUMNS)));
+      __m256i yv = _mm256_cvtepi8_epi16 (_mm_loadu_si128 (reinterpret_cast<const __m128i *> (y + b * QUANT_BLOCK_COLUMNS)));
+      acc = _mm256_add_epi32 (acc, _mm256_madd_epi16 (xv, yv));
+    }
+    _mm256_storeu_si256 (reinterpret_cast<__m256i *> (lanes), acc);
+    for (unsigned int l = 0; l < 8; l++) {
+      sum += lanes[l];
+    }
+  }
+
+  return sum;
+}
+
+//!  Dot product of two rows quantized to 16 bits
+/*!
+     A pair of products can take up all 32 bits of a lane, so the lanes
+     are widened and added into 64-bit lanes after every block.
+*/
+AVX2_FN static int64_t dotQuant16AVX2 (const int16_t *x, const int16_t *y, unsigned int n) {
+  unsigned int blocks = n / QUANT_BLOCK_COLUMNS;
+  __m256i acc[2];
+  int64_t lanes[8];
+  int64_t sum = 0;
+
+  acc[0] = _mm256_setzero_si256 ();
+  acc[1] = _mm256_setzero_si256 ();
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m256i xv = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (x + b * QUANT_BLOCK_COLUMNS));
+    __m256i yv = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (y + b * QUANT_BLOCK_COLUMNS));
+    __m256i pairs = _mm256_madd_epi16 (xv, yv);
+    acc[0] = _mm256_add_epi64 (acc[0], _mm256_cvtepi32_epi64 (_mm256_castsi256_si128 (pairs)));
+    acc[1] = _mm256_add_epi64 (acc[1], _mm256_cvtepi32_epi64 (_mm256_extracti128_si256 (pairs, 1)));
+  }
+  _mm256_storeu_si256 (reinterpret_cast<__m256i *> (lanes), acc[0]);
+  _mm256_storeu_si256 (reinterpret_cast<__m256i *> (lanes + 4), acc[1]);
+  for (unsigned int l = 0; l < 8; l++) {
+    sum += lanes[l];
+  }
+
+  return sum;
+}
+
+
+////////////////////////////////////////
+//  AVX-512 versions; all lanes are in one register and the valid flags are used directly as a mask
+
+#define AVX512_FN __attribute__ ((target ("avx512f")))
+
+//!  Load a block of columns from both rows; see loadSSE2 ()
+/*!
+     A masked load costs the same as a plain one, so rows with sparse NULLs
+     are always masked.
+*/
+template <NULL_PROFILE P>
+AVX512_FN static inline void loadAVX512 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int b, __m512d *xv, __m512d *yv) {
+  if (P == NULLS_NONE) {
+    *xv = _mm512_loadu_pd (x + b * SIMD_LANES);
+    *yv = _mm512_loadu_pd (y + b * SIMD_LANES);
+  }
+  else {
+    __mmask8 valid = static_cast<__mmask8> (validLanes (xn, yn, b));
+    *xv = _mm512_maskz_loadu_pd (valid, x + b * SIMD_LANES);
+    *yv = _mm512_maskz_loadu_pd (valid, y + b * SIMD_LANES);
+  }
+}
+
+template <NULL_PROFILE P>
+AVX512_FN static void sumSqDiffAVX512 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m512d acc = _mm512_setzero_pd ();
+
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m512d xv;
+    __m512d yv;
+    loadAVX512<P> (x, xn, y, yn, b, &xv, &yv);
+    __m512d temp = _mm512_sub_pd (xv, yv);
+    acc = _mm512_add_pd (acc, _mm512_mul_pd (temp, temp));
+  }
+  _mm512_storeu_pd (lanes, acc);
+}
+
+template <NULL_PROFILE P>
+AVX512_FN static void sumAbsDiffAVX512 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m512d acc = _mm512_setzero_pd ();
+
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m512d xv;
+    __m512d yv;
+    loadAVX512<P> (x, xn, y, yn, b, &xv, &yv);
+    acc = _mm512_add_pd (acc, _mm512_abs_pd (_mm512_sub_pd (xv, yv)));
+  }
+  _mm512_storeu_pd (lanes, acc);
+}
+
+template <NULL_PROFILE P>
+AVX512_FN static void sumPearsonAVX512 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m512d acc[5];
+
+  for (unsigned int s = 0; s < 5; s++) {
+    acc[s] = _mm512_setzero_pd ();
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m512d xv;
+    __m512d yv;
+    loadAVX512<P> (x, xn, y, yn, b, &xv, &yv);
+    acc[0] = _mm512_add_pd (acc[0], _mm512_mul_pd (xv, yv));
+    acc[1] = _mm512_add_pd (acc[1], xv);
+    acc[2] = _mm512_add_pd (acc[2], yv);
+    acc[3] = _mm512_add_pd (acc[3], _mm512_mul_pd (xv, xv));
+    acc[4] = _mm512_add_pd (acc[4], _mm512_mul_pd (yv, yv));
+  }
+  for (unsigned int s = 0; s < 5; s++) {
+    _mm512_storeu_pd (lanes + s * SIMD_LANES, acc[s]);
+  }
+}
+
+template <NULL_PROFILE P>
+AVX512_FN static void sumDotAVX512 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m512d acc = _mm512_setzero_pd ();
+
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m512d xv;
+    __m512d yv;
+    loadAVX512<P> (x, xn, y, yn, b, &xv, &yv);
+    acc = _mm512_add_pd (acc, _mm512_mul_pd (xv, yv));
+  }
+  _mm512_storeu_pd (lanes, acc);
+}
+
+template <NULL_PROFILE P>
+AVX512_FN static void sumUncenteredAVX512 (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m512d acc[3];
+
+  for (unsigned int s = 0; s < 3; s++) {
+    acc[s] = _mm512_setzero_pd ();
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    __m512d xv;
+    __m512d yv;
+    loadAVX512<P> (x, xn, y, yn, b, &xv, &yv);
+    acc[0] = _mm512_add_pd (acc[0], _mm512_mul_pd (xv, yv));
+    acc[1] = _mm512_add_pd (acc[1], _mm512_mul_pd (xv, xv));
+    acc[2] = _mm512_add_pd (acc[2], _mm512_mul_pd (yv, yv));
+  }
+  for (unsigned int s = 0; s < 3; s++) {
+    _mm512_storeu_pd (lanes + s * SIMD_LANES, acc[s]);
+  }
+}
+
+//!  Dot products of a block of rows; all (4 x 4) pairs are kept in registers
+AVX512_FN static void dotBlockAVX512 (const double *const *x, const double *const *y, unsigned int n, double *lanes) {
+  unsigned int blocks = (n + SIMD_LANES - 1) / SIMD_LANES;
+  __m512d acc[DOT_BLOCK_ROWS][DOT_BLOCK_ROWS];
+  __m512d yv[DOT_BLOCK_ROWS];
+
+  for (unsigned int r = 0; r < DOT_BLOCK_ROWS; r++) {
+    for (unsigned int c = 0; c < DOT_BLOCK_ROWS; c++) {
+      acc[r][c] = _mm512_setzero_pd ();
+    }
+  }
+  for (unsigned int b = 0; b < blocks; b++) {
+    for (unsigned int c = 0; c < DOT_BLOCK_ROWS; c++) {
+      yv[c] = _mm512_loadu_pd (y[c] + b * SIMD_LANES);
+    }
+    for (unsigned int r = 0; r < DOT_BLOCK_ROWS; r++) {
+      __m512d xv = _mm512_loadu_pd (x[r] + b * SIMD_LANES);
+      for (unsigned int c = 0; c < DOT_BLOCK_ROWS; c++) {
+        acc[r][c] = _mm512_add_pd (acc[r][c], _mm512_mul_pd (xv, yv[c]));
+      }
+    }
+  }
+  for (unsigned int r = 0; r < DOT_BLOCK_ROWS; r++) {
+    for (unsigned int c = 0; c < DOT_BLOCK_ROWS; c++) {
+      _mm512_storeu_pd (lanes + (r * DOT_BLOCK_ROWS + c) * SIMD_LANES, acc[r][c]);
+    }
+  }
+}
+#endif
+
+
+////////////////////////////////////////
+//  Dispatchers
+
+//!  Sum of squared differences between two rows, over the columns where neither is NULL
+/*!
+     \param x Expression levels of the first row
+     \param xn NULL bitmap of the first row
+     \param y Expression levels of the second row
+     \param yn NULL bitmap of the second row
+     \param n Number of columns
+     \param lanes Output of SIMD_LANES partial sums
+
+     P is the NULL profile of the two rows (or worse).
+*/
+template <NULL_PROFILE P>
+void sumSqDiff (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  switch (simd_level) {
+#if HAVE_X86_SIMD
+    case SIMD_AVX512 :
+      sumSqDiffAVX512<P> (x, xn, y, yn, n, lanes);
+      return;
+    case SIMD_AVX2 :
+      sumSqDiffAVX2<P> (x, xn, y, yn, n, lanes);
+      return;
+    case SIMD_SSE2 :
+      sumSqDiffSSE2<P> (x, xn, y, yn, n, lanes);
+      return;
+#endif
+    default :
+      sumSqDiffScalar<P> (x, xn, y, yn, n, lanes);
+      return;
+  }
+}
+
+//!  Sum of absolute differences between two rows, over the columns where neither is NULL
+/*!  See sumSqDiff () for the parameters.  */
+template <NULL_PROFILE P>
+void sumAbsDiff (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  switch (simd_level) {
+#if HAVE_X86_SIMD
+    case SIMD_AVX512 :
+      sumAbsDiffAVX512<P> (x, xn, y, yn, n, lanes);
+      return;
+    case SIMD_AVX2 :
+      sumAbsDiffAVX2<P> (x, xn, y, yn, n, lanes);
+      return;
+    case SIMD_SSE2 :
+      sumAbsDiffSSE2<P> (x, xn, y, yn, n, lanes);
+      return;
+#endif
+    default :
+      sumAbsDiffScalar<P> (x, xn, y, yn, n, lanes);
+      return;
+  }
+}
+
+//!  The five sums needed for the Pearson correlation, over the columns where neither row is NULL
+/*!
+     The output has 5 * SIMD_LANES partial sums, in the order:  sum of x * y,
+     sum of x, sum of y, sum of x * x, and sum of y * y.  See sumSqDiff () for
+     the other parameters.
+*/
+template <NULL_PROFILE P>
+void sumPearson (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  switch (simd_level) {
+#if HAVE_X86_SIMD
+    case SIMD_AVX512 :
+      sumPearsonAVX512<P> (x, xn, y, yn, n, lanes);
+      return;
+    case SIMD_AVX2 :
+      sumPearsonAVX2<P> (x, xn, y, yn, n, lanes);
+      return;
+    case SIMD_SSE2 :
+      sumPearsonSSE2<P> (x, xn, y, yn, n, lanes);
+      return;
+#endif
+    default :
+      sumPearsonScalar<P> (x, xn, y, yn, n, lanes);
+      return;
+  }
+}
+
+//!  Dot product of two rows, over the columns where neither is NULL
+/*!  See sumSqDiff () for the parameters.  */
+template <NULL_PROFILE P>
+void sumDot (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  switch (simd_level) {
+#if HAVE_X86_SIMD
+    case SIMD_AVX512 :
+      sumDotAVX512<P> (x, xn, y, yn, n, lanes);
+      return;
+    case SIMD_AVX2 :
+      sumDotAVX2<P> (x, xn, y, yn, n, lanes);
+      return;
+    case SIMD_SSE2 :
+      sumDotSSE2<P> (x, xn, y, yn, n, lanes);
+      return;
+#endif
+    default :
+      sumDotScalar<P> (x, xn, y, yn, n, lanes);
+      return;
+  }
+}
+
+//!  The three sums needed for the uncentered correlation, over the columns where neither row is NULL
+/*!
+     The output has 3 * SIMD_LANES partial sums, in the order:  sum of x * y,
+     sum of x * x, and sum of y * y.  See sumSqDiff () for the other
+     parameters.
+*/
+template <NULL_PROFILE P>
+void sumUncentered (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes) {
+  switch (simd_level) {
+#if HAVE_X86_SIMD
+    case SIMD_AVX512 :
+      sumUncenteredAVX512<P> (x, xn, y, yn, n, lanes);
+      return;
+    case SIMD_AVX2 :
+      sumUncenteredAVX2<P> (x, xn, y, yn, n, lanes);
+      return;
+    case SIMD_SSE2 :
+      sumUncenteredSSE2<P> (x, xn, y, yn, n, lanes);
+      return;
+#endif
+    default :
+      sumUncenteredScalar<P> (x, xn, y, yn, n, lanes);
+      return;
+  }
+}
+
+
+//!  Dot products between every pair of rows in two blocks of rows, which must not have any NULLs
+/*!
+     \param x Pointers to DOT_BLOCK_ROWS rows
+     \param y Pointers to DOT_BLOCK_ROWS rows
+     \param n Number of columns
+     \param lanes Output of SIMD_LANES partial sums for each pair; the sums
+            of the pair (x[r], y[c]) start at lanes[(r * DOT_BLOCK_ROWS + c) * SIMD_LANES]
+
+     The padding of each row must be zeroes.  The same row may appear more
+     than once in a block.
+*/
+void dotBlock (const double *const *x, const double *const *y, unsigned int n, double *lanes) {
+  switch (simd_level) {
+#if HAVE_X86_SIMD
+    case SIMD_AVX512 :
+      dotBlockAVX512 (x, y, n, lanes);
+      return;
+    case SIMD_AVX2 :
+      dotBlockAVX2 (x, y, n, lanes);
+      return;
+#endif
+    default :
+      dotBlockScalar (x, y, n, lanes);
+      return;
+  }
+}
+
+//!  Dot product of two rows quantized to 8 bits (see prepareQuantized ())
+/*!
+     \param x Quantized expression levels of the first row
+     \param y Quantized expression levels of the second row
+     \param n Number of columns; a multiple of QUANT_BLOCK_COLUMNS
+
+     The sums are exact, so every instruction set gives the same result.
+     There is no AVX-512 version, since widening the products to 32 bits
+     is the bottleneck; the AVX2 version is used instead.
+*/
+int64_t dotQuant8 (const int8_t *x, const int8_t *y, unsigned int n) {
+  switch (simd_level) {
+#if HAVE_X86_SIMD
+    case SIMD_AVX512 :
+    case SIMD_AVX2 :
+      return dotQuant8AVX2 (x, y, n);
+#endif
+    default :
+      return dotQuant8Scalar (x, y, n);
+  }
+}
+
+//!  Dot product of two rows quantized to 16 bits
+/*!  See dotQuant8 () for the parameters.  */
+int64_t dotQuant16 (const int16_t *x, const int16_t *y, unsigned int n) {
+  switch (simd_level) {
+#if HAVE_X86_SIMD
+    case SIMD_AVX512 :
+    case SIMD_AVX2 :
+      return dotQuant16AVX2 (x, y, n);
+#endif
+    default :
+      return dotQuant16Scalar (x, y, n);
+  }
+}
+
+//  Instantiate the kernels for each NULL profile
+template void sumSqDiff<NULLS_NONE> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumSqDiff<NULLS_SPARSE> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumSqDiff<NULLS_GENERAL> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumAbsDiff<NULLS_NONE> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumAbsDiff<NULLS_SPARSE> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumAbsDiff<NULLS_GENERAL> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumPearson<NULLS_NONE> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumPearson<NULLS_SPARSE> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumPearson<NULLS_GENERAL> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumDot<NULLS_NONE> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumDot<NULLS_SPARSE> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumDot<NULLS_GENERAL> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumUncentered<NULLS_NONE> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumUncentered<NULLS_SPARSE> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template void sumUncentered<NULLS_GENERAL> (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file vect_simd.hpp
+    Header file for the SIMD distance kernels
+      (NOT a class)
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#ifndef VECT_SIMD_HPP
+#define VECT_SIMD_HPP
+
+//  Selection of the instruction set  [vect_simd.cpp]
+SIMD_LEVEL detectSIMDLevel ();
+void setSIMDLevel (SIMD_LEVEL arg);
+SIMD_LEVEL getSIMDLevel ();
+
+//  Helper functions for the kernels  [vect_simd.cpp]
+unsigned int countNonNull (const uint64_t *xn, const uint64_t *yn, unsigned int words);
+double sumLanes (const double *lanes);
+
+//  Distance kernels, specialised by the NULL profile of the rows  [vect_simd.cpp]
+template <NULL_PROFILE P>
+void sumSqDiff (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template <NULL_PROFILE P>
+void sumAbsDiff (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template <NULL_PROFILE P>
+void sumPearson (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template <NULL_PROFILE P>
+void sumDot (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+template <NULL_PROFILE P>
+void sumUncentered (const double *x, const uint64_t *xn, const double *y, const uint64_t *yn, unsigned int n, double *lanes);
+
+//  Micro-kernel of the blocked distance engine  [vect_simd.cpp]
+void dotBlock (const double *const *x, const double *const *y, unsigned int n, double *lanes);
+
+//  Integer kernels for the rows quantized by --quantize  [vect_simd.cpp]
+int64_t dotQuant8 (const int8_t *x, const int8_t *y, unsigned int n);
+int64_t dotQuant16 (const int16_t *x, const int16_t *y, unsigned int n);
+
+#endif
+
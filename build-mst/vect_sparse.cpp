@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file vect_sparse.cpp
+    Functions for calculating distances between compressed sparse rows
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#include <cmath>  //  fabs
+
+using namespace std;
+
+#include "vect_sparse.hpp"
+
+
+//!  Sum of the squared differences between two sparse rows
+/*!
+     \param x_cols The non-zero columns of the first row, in increasing order
+     \param x_vals The expression levels of those columns
+     \param x_count The number of non-zero columns of the first row
+     \param y_cols The non-zero columns of the second row, in increasing order
+     \param y_vals The expression levels of those columns
+     \param y_count The number of non-zero columns of the second row
+     \return The sum over the union of the non-zero columns
+*/
+double sparseSqDiff (const unsigned int *x_cols, const double *x_vals, unsigned int x_count, const unsigned int *y_cols, const double *y_vals, unsigned int y_count) {
+  double sum = 0.0;
+  double temp = 0.0;
+  unsigned int a = 0;
+  unsigned int b = 0;
+
+  while ((a < x_count) && (b < y_count)) {
+    if (x_cols[a] == y_cols[b]) {
+      temp = x_vals[a++] - y_vals[b++];
+    }
+    else if (x_cols[a] < y_cols[b]) {
+      temp = x_vals[a++];
+    }
+    else {
+      temp = y_vals[b++];
+    }
+    sum += temp * temp;
+  }
+  for (; a < x_count; a++) {
+    sum += x_vals[a] * x_vals[a];
+  }
+  for (; b < y_count; b++) {
+    sum += y_vals[b] * y_vals[b];
+  }
+
+  return sum;
+}
+
+
+//!  Sum of the absolute differences between two sparse rows
+/*!
+     See sparseSqDiff () for the parameters.
+*/
+double sparseAbsDiff (const unsigned int *x_cols, const double *x_vals, unsigned int x_count, const unsigned int *y_cols, const double *y_vals, unsigned int y_count) {
+  double sum = 0.0;
+  unsigned int a = 0;
+  unsigned int b = 0;
+
+  while ((a < x_count) && (b < y_count)) {
+    if (x_cols[a] == y_cols[b]) {
+      sum += fabs (x_vals[a++] - y_vals[b++]);
+    }
+    else if (x_cols[a] < y_cols[b]) {
+      sum += fabs (x_vals[a++]);
+    }
+    else {
+      sum += fabs (y_vals[b++]);
+    }
+  }
+  for (; a < x_count; a++) {
+    sum += fabs (x_vals[a]);
+  }
+  for (; b < y_count; b++) {
+    sum += fabs (y_vals[b]);
+  }
+
+  return sum;
+}
+
+
+//!  Dot product of two sparse rows
+/*!
+     See sparseSqDiff () for the parameters.  Only the columns which are
+     non-zero in both rows are visited.
+*/
+double sparseDot (const unsigned int *x_cols, const double *x_vals, unsigned int x_count, const unsigned int *y_cols, const double *y_vals, unsigned int y_count) {
+  double sum = 0.0;
+  unsigned int a = 0;
+  unsigned int b = 0;
+
+  while ((a < x_count) && (b < y_count)) {
+    if (x_cols[a] == y_cols[b]) {
+      sum += x_vals[a++] * y_vals[b++];
+    }
+    else if (x_cols[a] < y_cols[b]) {
+      a++;
+    }
+    else {
+      b++;
+    }
+  }
+
+  return sum;
+}
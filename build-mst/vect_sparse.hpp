@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////
+//  HAMSTER
+//  Software for depicting microarray data sets as a set of minimum spanning
+//    trees.
+//  
+//  Version 1.3 -- August 26, 2011
+//  
+//  Copyright (C) 2009-2011 by Raymond Wan, All rights reserved.
+//  Contact:  r-wan@cb.k.u-tokyo.ac.jp
+//  Organization:  Department of Computational Biology, Graduate School of
+//                 Frontier Science, University of Tokyo and
+//                 Computational Biology Research Center, AIST,
+//                 Japan
+//  
+//  This file is part of HAMSTER.
+//  
+//  HAMSTER is free software; you can redistribute it and/or 
+//  modify it under the terms of the GNU Lesser General Public License 
+//  as published by the Free Software Foundation; either version 
+//  3 of the License, or (at your option) any later version.
+//  
+//  HAMSTER is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//  
+//  You should have received a copy of the GNU Lesser General Public 
+//  License along with HAMSTER; if not, see 
+//  <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////////
+
+
+/*******************************************************************/
+/*!
+    \file vect_sparse.hpp
+    Header file for the distance functions between compressed sparse rows
+    
+    \author Raymond Wan (r-wan@cb.k.u-tokyo.ac.jp)
+    \par Organizations
+          - Department of Computational Biology, Graduate School of
+            Frontier Science, University of Tokyo
+          - Computational Biology Research Center, AIST, Japan
+          
+    $Id$
+
+*/
+/*******************************************************************/
+
+
+#ifndef VECT_SPARSE_HPP
+#define VECT_SPARSE_HPP
+
+/*!
+     Count matrices (i.e., from single-cell experiments) are mostly zeroes.
+     A row like this can be stored as the columns and values of its non-zero
+     expression levels only, sorted by column.  The functions below walk
+     through two such rows together like the merge step of a merge sort,
+     so they take time in proportion to the number of non-zeroes instead
+     of the number of columns.
+
+     The squared and absolute differences are summed over the union of
+     the non-zero columns, since a column that is zero in only one row
+     still contributes.  The dot product is only summed over their
+     intersection.  Sparse rows never have NULLs.
+*/
+
+//  Sum of the squared differences between two sparse rows  [vect_sparse.cpp]
+double sparseSqDiff (const unsigned int *x_cols, const double *x_vals, unsigned int x_count, const unsigned int *y_cols, const double *y_vals, unsigned int y_count);
+
+//  Sum of the absolute differences between two sparse rows  [vect_sparse.cpp]
+double sparseAbsDiff (const unsigned int *x_cols, const double *x_vals, unsigned int x_count, const unsigned int *y_cols, const double *y_vals, unsigned int y_count);
+
+//  Dot product of two sparse rows  [vect_sparse.cpp]
+double sparseDot (const unsigned int *x_cols, const double *x_vals, unsigned int x_count, const unsigned int *y_cols, const double *y_vals, unsigned int y_count);
+
+#endif
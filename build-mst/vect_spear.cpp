@@ -48,6 +48,7 @@
 
 #include <vector>
 #include <iostream>
+#include <algorithm>  //  sort
 
 using namespace std;
 
@@ -115,4 +116,55 @@ void SPEARMAN::copyOrigPosToKey () {
   key = origpos;
 }
 
+//!  Assign ranks to a vector of SPEARMAN nodes
+/*!
+     \param spears The SPEARMAN nodes, in their original order
 
+     The nodes are sorted by value and enumerated (i.e., assigned ranks),
+     with tied values given the average of their ranks.  They are then
+     returned to their original order.
+*/
+void rankSpearman (vector<SPEARMAN> &spears) {
+  unsigned int i = 0;
+  unsigned int j = 0;
+  unsigned int k = 0;
+  unsigned int n = spears.size ();
+
+  //  Sort vector of spearman nodes by value
+  sort (spears.begin (), spears.end ());
+
+  //  Assign rank
+  for (i = 0; i < n; i++) {
+    spears[i].setRank (i);
+  }
+
+  //  Handle duplicate ranks
+  i = 0;
+  while (i < n) {
+    unsigned int dups = 1;
+    double ranksum = spears[i].getRank ();
+    for (j = i + 1; j < n; j++) {
+      if (spears[i].getValue () != spears[j].getValue ()) {
+        break;
+      }
+      else {
+        ranksum += spears[j].getRank ();
+        dups++;
+      }
+    }
+    for (k = i; k < j; k++) {
+      spears[k].setRank (ranksum / dups);
+    }
+    i = j;
+  }
+
+  //  Copy original positions to key
+  for (i = 0; i < n; i++) {
+    spears[i].copyOrigPosToKey ();
+  }
+
+  //  Sort by original positions
+  sort (spears.begin (), spears.end ());
+
+  return;
+}
@@ -86,5 +86,8 @@ class SPEARMAN {
     double rank;
 };
 
+//  Assign ranks to a vector of SPEARMAN nodes  [vect_spear.cpp]
+void rankSpearman (vector<SPEARMAN> &spears);
+
 #endif
 